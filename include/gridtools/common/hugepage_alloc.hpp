@@ -15,9 +15,13 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <map>
+#include <mutex>
 #include <new>
 #include <stdexcept>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #ifdef __linux__
 #include <cstdio>
@@ -25,6 +29,7 @@
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <unistd.h>
 #endif
@@ -40,6 +45,55 @@ namespace gridtools {
 
         enum class hugepage_mode { disabled, transparent, explicit_allocation };
 
+        enum class numa_policy { none, interleave, bind };
+
+        // maximal number of NUMA nodes that can be passed to mbind
+        constexpr std::size_t max_numa_nodes = 1024;
+
+        struct numa_config {
+            numa_policy policy = numa_policy::none;
+            unsigned long nodes[max_numa_nodes / (8 * sizeof(unsigned long))] = {};
+
+            void add_node(std::size_t node) {
+                constexpr std::size_t bits = 8 * sizeof(unsigned long);
+                if (node < max_numa_nodes)
+                    nodes[node / bits] |= 1ul << (node % bits);
+            }
+
+            bool has_nodes() const { return node_count() != 0; }
+
+            std::size_t node_count() const {
+                std::size_t res = 0;
+                for (auto word : nodes)
+                    for (; word; word &= word - 1)
+                        ++res;
+                return res;
+            }
+        };
+
+        // parses node lists like `0-3,6`
+        inline bool parse_node_list(const char *str, numa_config &config) {
+            while (*str && *str != '\n') {
+                char *end;
+                std::size_t first = std::strtoul(str, &end, 10);
+                if (end == str)
+                    return false;
+                std::size_t last = first;
+                str = end;
+                if (*str == '-') {
+                    last = std::strtoul(str + 1, &end, 10);
+                    if (end == str + 1)
+                        return false;
+                    str = end;
+                }
+                for (std::size_t node = first; node <= last; ++node)
+                    config.add_node(node);
+                if (*str == ',')
+                    ++str;
+            }
+            return config.has_nodes();
+        }
+
 #ifdef __linux__
         inline std::size_t get_sysinfo(const char *info, std::size_t default_value) {
             int fd = open(info, O_RDONLY);
@@ -85,6 +139,40 @@ namespace gridtools {
             return value;
         }
 
+        // size of the data (or unified) cache of the given level, as seen by cpu0
+        inline std::size_t get_cache_size(std::size_t level, std::size_t default_value) {
+            char path[64];
+            for (int index = 0; index < 16; ++index) {
+                std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", index);
+                if (get_sysinfo(path, 0) != level)
+                    continue;
+                char type[16] = {};
+                std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", index);
+                if (auto *fp = std::fopen(path, "r")) {
+                    if (std::fscanf(fp, "%15s", type) != 1)
+                        type[0] = 0;
+                    std::fclose(fp);
+                }
+                if (std::strcmp(type, "Instruction") == 0)
+                    continue;
+                std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+                if (auto *fp = std::fopen(path, "r")) {
+                    std::size_t size;
+                    char unit = 0;
+                    int matched = std::fscanf(fp, "%zu%c", &size, &unit);
+                    std::fclose(fp);
+                    if (matched > 0)
+                        return unit == 'K' ? size * 1024 : unit == 'M' ? size * 1024 * 1024 : size;
+                }
+            }
+            return default_value;
+        }
+
+        inline std::size_t l2_cache_size() {
+            static const std::size_t value = get_cache_size(2, 1024 * 1024);
+            return value;
+        }
+
         inline std::size_t page_size() {
             static const std::size_t value = sysconf(_SC_PAGESIZE);
             return value;
@@ -125,6 +213,34 @@ namespace gridtools {
             return {ptr, size};
         }
 
+        inline void online_numa_nodes(numa_config &config) {
+            if (auto *fp = std::fopen("/sys/devices/system/node/online", "r")) {
+                char buffer[256] = {};
+                if (std::fgets(buffer, sizeof(buffer), fp))
+                    parse_node_list(buffer, config);
+                std::fclose(fp);
+            }
+            if (!config.has_nodes())
+                config.add_node(0);
+        }
+
+        // applies the NUMA policy to the pages of a fresh allocation, the pages are placed at the first touch
+        inline void apply_numa_policy(void *ptr, std::size_t size, numa_config const &config) {
+            if (config.policy == numa_policy::none)
+                return;
+#ifdef SYS_mbind
+            // MPOL_BIND and MPOL_INTERLEAVE from <numaif.h>, to not depend on libnuma
+            constexpr int mpol_bind = 2;
+            constexpr int mpol_interleave = 3;
+            int mode = config.policy == numa_policy::bind ? mpol_bind : mpol_interleave;
+            if (syscall(SYS_mbind, ptr, size, mode, config.nodes, max_numa_nodes + 1, 0) == 0)
+                return;
+#endif
+            static std::atomic<bool> s_warned(false);
+            if (!s_warned.exchange(true))
+                std::fprintf(stderr, "warning: could not apply the NUMA policy from GT_NUMA_POLICY\n");
+        }
+
         inline void deallocate(void *ptr, std::size_t size, hugepage_mode mode) {
             switch (mode) {
             case hugepage_mode::disabled:
@@ -149,6 +265,10 @@ namespace gridtools {
             return 2 * 1024 * 1024; // 2MB is the default on most systems
         }
 
+        inline std::size_t l2_cache_size() {
+            return 1024 * 1024; // 1MB is a common size on recent x86-64 archs
+        }
+
         inline std::size_t page_size() {
             return 4 * 1024; // 4kB is the default on most systems
         }
@@ -163,6 +283,10 @@ namespace gridtools {
         }
 
         inline void deallocate(void *ptr, std::size_t, hugepage_mode) { free(ptr); }
+
+        inline void online_numa_nodes(numa_config &config) { config.add_node(0); }
+
+        inline void apply_numa_policy(void *, std::size_t, numa_config const &) {}
 #endif
 
         inline std::size_t allocation_offset() {
@@ -182,16 +306,214 @@ namespace gridtools {
             return hugepage_mode::transparent;
         }
 
+        /*
+         * GT_NUMA_POLICY is `interleave` or `bind`, optionally followed by a node list, e.g. `interleave:0-3` or
+         * `bind:1`. Without node list, all online nodes are used. If not set, the pages are placed at first touch. The
+         * allocations read the variable only once, see `process_numa_config`.
+         */
+        inline numa_config numa_config_from_env() {
+            numa_config res;
+            const char *env_value = std::getenv("GT_NUMA_POLICY");
+            if (!env_value || !*env_value)
+                return res;
+            const char *nodes = std::strchr(env_value, ':');
+            std::size_t name_length = nodes ? nodes - env_value : std::strlen(env_value);
+            if (name_length == 10 && std::strncmp(env_value, "interleave", 10) == 0)
+                res.policy = numa_policy::interleave;
+            else if (name_length == 4 && std::strncmp(env_value, "bind", 4) == 0)
+                res.policy = numa_policy::bind;
+            else {
+                std::fprintf(stderr, "warning: env variable GT_NUMA_POLICY set to invalid value '%s'\n", env_value);
+                return res;
+            }
+            if (!nodes)
+                online_numa_nodes(res);
+            else if (!parse_node_list(nodes + 1, res)) {
+                std::fprintf(stderr, "warning: env variable GT_NUMA_POLICY set to invalid value '%s'\n", env_value);
+                res.policy = numa_policy::none;
+            }
+            return res;
+        }
+
+        // the policy of the process, read once
+        inline numa_config const &process_numa_config() {
+            static const numa_config value = numa_config_from_env();
+            return value;
+        }
+
+        /*
+         * True if the pages are placed by the first touch on a machine with several NUMA nodes. The storage
+         * initializers then touch every page from the thread that computes on it, reused or prefaulted pages would
+         * stay on the node of their earlier toucher.
+         */
+        inline bool first_touch_placement() {
+            static const bool value = [] {
+                if (process_numa_config().policy != numa_policy::none)
+                    return false;
+                numa_config online;
+                online_numa_nodes(online);
+                return online.node_count() > 1;
+            }();
+            return value;
+        }
+
         struct ptr_metadata {
             std::size_t offset, full_size;
             hugepage_mode mode;
         };
 
+        // parses sizes like `512M`, returns the default value if the variable is not set
+        inline std::size_t size_from_env(const char *name, std::size_t default_value) {
+            const char *env_value = std::getenv(name);
+            if (!env_value || !*env_value)
+                return default_value;
+            char *end;
+            std::size_t res = std::strtoull(env_value, &end, 10);
+            switch (*end) {
+            case 'G':
+                res *= 1024;
+                [[fallthrough]];
+            case 'M':
+                res *= 1024;
+                [[fallthrough]];
+            case 'K':
+                res *= 1024;
+                ++end;
+            }
+            if (end == env_value || *end) {
+                std::fprintf(stderr, "warning: env variable %s set to invalid value '%s'\n", name, env_value);
+                return default_value;
+            }
+            return res;
+        }
+
+        inline std::size_t allocation_granularity(hugepage_mode mode) {
+            return mode == hugepage_mode::disabled ? page_size() : hugepage_size();
+        }
+
+        /*
+         * Sizes are rounded up to the allocation granularity, larger sizes to one of four classes per power of two.
+         * This bounds the waste to 25% while allocations of similar sizes share the free lists.
+         */
+        inline std::size_t size_class(std::size_t size, std::size_t granularity) {
+            size = (size + granularity - 1) / granularity * granularity;
+            if (size <= 4 * granularity)
+                return size;
+            std::size_t step = (std::size_t(1) << ilog2(size)) / 4;
+            return (size + step - 1) / step * step;
+        }
+
+        struct pool_statistics {
+            std::size_t hits = 0;           // allocations served from the pool
+            std::size_t misses = 0;         // allocations that needed fresh memory
+            std::size_t retained_bytes = 0; // freed memory kept in the pool
+            std::size_t in_use_bytes = 0;   // memory handed out and not freed yet
+        };
+
+        /*
+         * Process-wide pool of the freed allocations, with one free list per size class and hugepage mode. The
+         * retained memory is bounded by GT_HUGEPAGE_POOL_LIMIT (default 1G, 0 disables the pool). With
+         * GT_HUGEPAGE_PREFAULT=1, fresh allocations are faulted in by the allocating thread.
+         *
+         * Under first touch placement on several NUMA nodes, the pool is disabled unless GT_HUGEPAGE_POOL_LIMIT is set
+         * and the prefaulting is skipped. Without pool, the sizes are not rounded to size classes.
+         */
+        class pool {
+            std::mutex m_mutex;
+            std::map<std::pair<hugepage_mode, std::size_t>, std::vector<void *>> m_free;
+            std::size_t m_limit =
+                size_from_env("GT_HUGEPAGE_POOL_LIMIT", first_touch_placement() ? 0 : std::size_t(1) << 30);
+            bool m_prefault = !first_touch_placement() && size_from_env("GT_HUGEPAGE_PREFAULT", 0) != 0;
+            pool_statistics m_statistics;
+
+            void trim(std::size_t limit) {
+                for (auto it = m_free.begin(); it != m_free.end() && m_statistics.retained_bytes > limit;) {
+                    auto &blocks = it->second;
+                    while (!blocks.empty() && m_statistics.retained_bytes > limit) {
+                        hugepage_alloc_impl_::deallocate(blocks.back(), it->first.second, it->first.first);
+                        blocks.pop_back();
+                        m_statistics.retained_bytes -= it->first.second;
+                    }
+                    it = blocks.empty() ? m_free.erase(it) : std::next(it);
+                }
+            }
+
+          public:
+            pool() = default;
+            pool(pool const &) = delete;
+            pool &operator=(pool const &) = delete;
+            ~pool() { trim(0); }
+
+            // the size of the block that is allocated for `size` bytes
+            std::size_t block_size(std::size_t size, hugepage_mode mode) {
+                std::size_t granularity = allocation_granularity(mode);
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (m_limit != 0)
+                        return size_class(size, granularity);
+                }
+                return (size + granularity - 1) / granularity * granularity;
+            }
+
+            // `size` has to be a block size
+            void *allocate(std::size_t size, hugepage_mode mode) {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_statistics.in_use_bytes += size;
+                    auto found = m_free.find({mode, size});
+                    if (found != m_free.end() && !found->second.empty()) {
+                        void *res = found->second.back();
+                        found->second.pop_back();
+                        m_statistics.retained_bytes -= size;
+                        ++m_statistics.hits;
+                        return res;
+                    }
+                    ++m_statistics.misses;
+                }
+                void *res;
+                std::tie(res, size) = hugepage_alloc_impl_::allocate(size, mode);
+                apply_numa_policy(res, size, process_numa_config());
+                if (m_prefault)
+                    for (std::size_t i = 0; i < size; i += page_size())
+                        static_cast<volatile char *>(res)[i] = 0;
+                return res;
+            }
+
+            void deallocate(void *ptr, std::size_t size, hugepage_mode mode) {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_statistics.in_use_bytes -= size;
+                    if (m_statistics.retained_bytes + size <= m_limit) {
+                        m_free[{mode, size}].push_back(ptr);
+                        m_statistics.retained_bytes += size;
+                        return;
+                    }
+                }
+                hugepage_alloc_impl_::deallocate(ptr, size, mode);
+            }
+
+            void set_limit(std::size_t limit) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_limit = limit;
+                trim(limit);
+            }
+
+            pool_statistics statistics() {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_statistics;
+            }
+        };
+
+        inline pool &global_pool() {
+            static pool res;
+            return res;
+        }
     } // namespace hugepage_alloc_impl_
 
     /**
      * @brief Allocates huge page memory (if GT_NO_HUGETLB is not defined) and shifts allocations by some bytes to
-     * reduce cache set conflicts.
+     * reduce cache set conflicts. The NUMA placement of the pages can be set with GT_NUMA_POLICY. Freed memory is
+     * kept in a pool and reused by later allocations of the same size class.
      */
     inline void *hugepage_alloc(std::size_t size) {
         // get allocation offset to reduce L1 cache conflicts
@@ -201,9 +523,10 @@ namespace gridtools {
         // get allocation mode from environment
         auto mode = hugepage_alloc_impl_::hugepage_mode_from_env();
 
-        // allocate memory with additional space for offsetting
-        void *ptr;
-        std::tie(ptr, size) = hugepage_alloc_impl_::allocate(size + offset, mode);
+        // allocate memory with additional space for offsetting, preferably from the pool of freed allocations
+        auto &pool = hugepage_alloc_impl_::global_pool();
+        size = pool.block_size(size + offset, mode);
+        void *ptr = pool.allocate(size, mode);
 
         // offset pointer and write pointer metadata required for deallocation
         ptr = static_cast<char *>(ptr) + offset;
@@ -211,6 +534,16 @@ namespace gridtools {
         return ptr;
     }
 
+    /**
+     * @brief Size of the per-core L2 cache in bytes.
+     */
+    inline std::size_t l2_cache_size() { return hugepage_alloc_impl_::l2_cache_size(); }
+
+    /**
+     * @brief Size of the (small) memory pages in bytes.
+     */
+    inline std::size_t page_size() { return hugepage_alloc_impl_::page_size(); }
+
     /**
      * @brief Frees memory allocated by hugepage_alloc.
      */
@@ -219,8 +552,23 @@ namespace gridtools {
             return;
         // read pointer metadata and compute originally allocated ptr value
         auto &metadata = static_cast<hugepage_alloc_impl_::ptr_metadata *>(ptr)[-1];
-        // free originally allocated pointer
-        hugepage_alloc_impl_::deallocate(static_cast<char *>(ptr) - metadata.offset, metadata.full_size, metadata.mode);
+        // return originally allocated pointer to the pool
+        hugepage_alloc_impl_::global_pool().deallocate(
+            static_cast<char *>(ptr) - metadata.offset, metadata.full_size, metadata.mode);
+    }
+
+    using hugepage_pool_statistics = hugepage_alloc_impl_::pool_statistics;
+
+    /**
+     * @brief Usage statistics of the pool behind hugepage_alloc.
+     */
+    inline hugepage_pool_statistics hugepage_pool_get_statistics() {
+        return hugepage_alloc_impl_::global_pool().statistics();
     }
 
+    /**
+     * @brief Sets the maximal amount of freed memory that is retained in the pool, the excess is released.
+     */
+    inline void hugepage_pool_set_limit(std::size_t bytes) { hugepage_alloc_impl_::global_pool().set_limit(bytes); }
+
 } // namespace gridtools
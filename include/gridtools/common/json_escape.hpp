@@ -0,0 +1,27 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <string>
+
+namespace gridtools {
+    /**
+     * @brief Escapes the quotes and backslashes of a string that is written as a JSON string literal.
+     */
+    inline std::string json_escape(std::string const &str) {
+        std::string res;
+        for (char c : str) {
+            if (c == '"' || c == '\\')
+                res += '\\';
+            res += c;
+        }
+        return res;
+    }
+} // namespace gridtools
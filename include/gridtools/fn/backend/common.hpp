@@ -9,11 +9,18 @@
  */
 #pragma once
 
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
 #include "../../common/hymap.hpp"
+#include "../../common/integral_constant.hpp"
 #include "../../common/tuple_util.hpp"
-#include "../../meta/rename.hpp"
+#include "../../meta.hpp"
+#include "../../sid/composite.hpp"
 #include "../../sid/concept.hpp"
 #include "../../sid/loop.hpp"
+#include "../extents.hpp"
 
 namespace gridtools::fn::backend {
 
@@ -35,9 +42,61 @@ namespace gridtools::fn::backend {
         constexpr GT_FUNCTION auto make_loops(Sizes const &sizes) {
             return make_loops<get_keys<Sizes>>(sizes);
         }
+
+        // The sizes extended by Extents, with all values converted to (compile time) ints
+        template <class Extents, class Sizes>
+        auto extended_sizes(Sizes const &sizes) {
+            return tuple_util::transform(
+                [](auto size) {
+                    if constexpr (is_gr_integral_constant<decltype(size)>::value)
+                        return integral_constant<int, decltype(size)::value>();
+                    else
+                        return int(size);
+                },
+                extend_sizes<Extents>(sizes));
+        }
+
+        // Composite of the sids, keyed by their positions
+        template <class Sids>
+        auto make_composite(Sids &&sids) {
+            using keys_t = meta::iseq_to_list<std::make_integer_sequence<int, std::tuple_size_v<std::decay_t<Sids>>>,
+                sid::composite::keys,
+                integral_constant>;
+            return tuple_util::convert_to<keys_t::template values>(std::forward<Sids>(sids));
+        }
     } // namespace common
 
     template <class T>
     struct data_type {};
 
+    // Placeholder argument for a temporary that lives only during a single execution.
+    // Stages writing it are computed on the domain extended by Extents.
+    template <class T, class Extents>
+    struct local_tmp {
+        static_assert(is_extents<Extents>::value);
+    };
+
+    template <class>
+    struct is_local_tmp : std::false_type {};
+
+    template <class T, class Extents>
+    struct is_local_tmp<local_tmp<T, Extents>> : std::true_type {};
+
+    namespace common {
+        template <class>
+        struct local_tmp_extents {
+            using type = extents<>;
+        };
+
+        template <class T, class Extents>
+        struct local_tmp_extents<local_tmp<T, Extents>> {
+            using type = Extents;
+        };
+
+        // The extents of the computation domain of a stage: those of the temporary it writes or none
+        template <class Args, class Stage>
+        using stage_extents = typename local_tmp_extents<
+            meta::at<meta::rename<meta::list, Args>, meta::first<typename Stage::outs_t>>>::type;
+    } // namespace common
+
 } // namespace gridtools::fn::backend
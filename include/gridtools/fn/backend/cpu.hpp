@@ -0,0 +1,513 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "../../common/array.hpp"
+#include "../../common/for_each.hpp"
+#include "../../common/hymap.hpp"
+#include "../../common/int_vector.hpp"
+#include "../../common/integral_constant.hpp"
+#include "../../common/tuple_util.hpp"
+#include "../../meta.hpp"
+#include "../../sid/allocator.hpp"
+#include "../../sid/block.hpp"
+#include "../../sid/blocked_dim.hpp"
+#include "../../sid/concept.hpp"
+#include "../../sid/contiguous.hpp"
+#include "../../sid/multi_shift.hpp"
+#include "../../sid/sid_shift_origin.hpp"
+#include "../../sid/unknown_kind.hpp"
+#include "../../thread_pool/concept.hpp"
+#include "../../thread_pool/omp.hpp"
+#include "../extents.hpp"
+#include "./common.hpp"
+
+namespace gridtools::fn::backend {
+    namespace cpu_impl_ {
+        /*
+         * BlockSizes must be a meta map, mapping dimensions to integral constant block sizes.
+         * The blocks are distributed among the threads of the ThreadPool, the iteration within a block is serial.
+         * Dimensions that are not present in the map are not blocked. At most three dimensions are blocked.
+         *
+         * For example, meta::list<meta::list<dim::i, integral_constant<int, 8>>,
+         *                         meta::list<dim::j, integral_constant<int, 8>>>;
+         * When using a cartesian grid.
+         *
+         * If ColumnWidth is larger than one, column stages advance packs of ColumnWidth neighbouring columns in
+         * lockstep. The columns of a pack are neighbours along the horizontal dimension in which the sids have the
+         * smallest strides, that is the unit stride dimension for the usual layouts.
+         */
+        template <class BlockSizes,
+            class ThreadPool = thread_pool::omp,
+            class ColumnWidth = integral_constant<int, 1>>
+        struct cpu {
+            using block_sizes_t = BlockSizes;
+        };
+
+        template <class BlockSizes>
+        struct is_blocked_f {
+            template <class Dim>
+            using apply = std::negation<std::is_void<meta::mp_find<BlockSizes, Dim>>>;
+        };
+
+        template <class BlockSizes, class Dim>
+        using block_size = meta::second<meta::mp_find<BlockSizes, Dim>>;
+
+        template <class BlockSizes, class Sizes, class Dims = meta::filter<is_blocked_f<BlockSizes>::template apply,
+                                                     get_keys<Sizes>>>
+        using blocked_dims = meta::take_c<std::min(3, (int)meta::length<Dims>::value), Dims>;
+
+        template <class BlockSizes, class Offsets>
+        struct block_sizes_f {
+            Offsets const &m_offsets;
+
+            template <class Dim, class Size>
+            auto operator()(Size size) const {
+                if constexpr (has_key<Offsets, Dim>()) {
+                    return std::min(int(block_size<BlockSizes, Dim>::value), int(size) - at_key<Dim>(m_offsets));
+                } else {
+                    return size;
+                }
+            }
+        };
+
+        // Calls `fun(block_indices)` for every block in parallel, `block_indices` maps the blocked dims to ints
+        template <class BlockSizes, class ThreadPool, class Sizes, class Fun>
+        void for_each_block(Sizes const &sizes, Fun const &fun) {
+            using dims_t = blocked_dims<BlockSizes, Sizes>;
+            if constexpr (meta::is_empty<dims_t>::value) {
+                fun(hymap::keys<>::values<>());
+            } else {
+                auto n_blocks = tuple_util::transform(
+                    [&](auto dim) {
+                        using dim_t = decltype(dim);
+                        constexpr int block_size_v = block_size<BlockSizes, dim_t>::value;
+                        return (int(at_key<dim_t>(sizes)) + block_size_v - 1) / block_size_v;
+                    },
+                    meta::rename<tuple, dims_t>());
+                tuple_util::apply(
+                    [&](auto... limits) {
+                        thread_pool::parallel_for_loop(
+                            ThreadPool(),
+                            [&](auto... block_indices) {
+                                fun(hymap::convert_to<hymap::keys, dims_t>(tuple(int(block_indices)...)));
+                            },
+                            limits...);
+                    },
+                    std::move(n_blocks));
+            }
+        }
+
+        template <class BlockSizes, class BlockIndices, class Dims = get_keys<BlockIndices>>
+        auto block_offsets(BlockIndices const &block_indices) {
+            return hymap::convert_to<hymap::keys, Dims>(tuple_util::transform(
+                [](auto dim, int index) { return index * block_size<BlockSizes, decltype(dim)>::value; },
+                meta::rename<tuple, Dims>(),
+                block_indices));
+        }
+
+        // Calls `block_fun(ptr, strides, block_sizes)` for every block in parallel
+        template <class BlockSizes, class ThreadPool, class Sizes, class PtrHolder, class Strides, class BlockFun>
+        void parallel_for_blocks(
+            Sizes const &sizes, PtrHolder const &ptr_holder, Strides const &strides, BlockFun const &block_fun) {
+            for_each_block<BlockSizes, ThreadPool>(sizes, [&](auto const &block_indices) {
+                auto offsets = block_offsets<BlockSizes>(block_indices);
+                auto ptr = ptr_holder();
+                sid::multi_shift(ptr, strides, offsets);
+                block_fun(std::move(ptr),
+                    strides,
+                    hymap::transform(block_sizes_f<BlockSizes, decltype(offsets)>{offsets}, sizes));
+            });
+        }
+
+        template <class BlockSizes,
+            class ThreadPool,
+            class ColumnWidth,
+            class Sizes,
+            class StencilStage,
+            class MakeIterator,
+            class Composite>
+        void apply_stencil_stage(cpu<BlockSizes, ThreadPool, ColumnWidth>,
+            Sizes const &sizes,
+            StencilStage,
+            MakeIterator &&make_iterator,
+            Composite &&composite) {
+            auto ptr_holder = sid::get_origin(std::forward<Composite>(composite));
+            auto strides = sid::get_strides(std::forward<Composite>(composite));
+            parallel_for_blocks<BlockSizes, ThreadPool>(sizes,
+                ptr_holder,
+                strides,
+                [fun = [make_iterator = make_iterator()](auto ptr, auto const &strides) {
+                    StencilStage()(make_iterator, ptr, strides);
+                }](auto ptr, auto const &strides, auto const &block_sizes) {
+                    common::make_loops(block_sizes)(fun)(std::move(ptr), strides);
+                });
+        }
+
+        // The tiles of the different threads are laid out along this dimension in local temporaries
+        struct thread_dim {};
+
+        template <class BlockSizes>
+        struct block_size_f {
+            template <class Dim>
+            using apply = block_size<BlockSizes, Dim>;
+        };
+
+        template <class BlockSizes, class Dims>
+        using block_map = meta::rename<meta::rename<hymap::keys, Dims>::template values,
+            meta::transform<block_size_f<BlockSizes>::template apply, Dims>>;
+
+        template <class BlockSizes, class Dims>
+        struct tile_sizes_f {
+            template <class Dim, class Size>
+            auto operator()(Size size) const {
+                if constexpr (meta::st_contains<Dims, Dim>::value) {
+                    return block_size<BlockSizes, Dim>();
+                } else {
+                    return size;
+                }
+            }
+        };
+
+        // Local temporaries are allocated with the extended tile size per thread, all other sids are blocked
+        template <class BlockSizes, class ThreadPool, class Dims, class Allocator, class TileSizes>
+        struct make_tile_sid_f {
+            Allocator &m_alloc;
+            TileSizes const &m_tile_sizes;
+
+            template <class T, class Extents>
+            auto operator()(local_tmp<T, Extents>) const {
+                using namespace int_vector::arithmetic;
+                auto sizes = hymap::concat(common::extended_sizes<Extents>(m_tile_sizes),
+                    hymap::keys<thread_dim>::make_values(thread_pool::get_max_threads(ThreadPool())));
+                return sid::shift_sid_origin(allocate_global_tmp(m_alloc, sizes, data_type<T>()), -Extents::offsets());
+            }
+
+            template <class Sid>
+            auto operator()(Sid const &sid) const {
+                return sid::block(Sid(sid), block_map<BlockSizes, Dims>());
+            }
+        };
+
+        // All stages are executed tile by tile, each one is computed on the tile extended by the extents of its output
+        template <class Args,
+            class BlockSizes,
+            class ThreadPool,
+            class ColumnWidth,
+            class Sizes,
+            class StageSpecs,
+            class MakeIterator,
+            class Composite>
+        void apply_stencil_stages_in_tiles(cpu<BlockSizes, ThreadPool, ColumnWidth>,
+            Sizes const &sizes,
+            StageSpecs,
+            MakeIterator const &make_iterator,
+            Composite &&composite) {
+            using dims_t = blocked_dims<BlockSizes, Sizes>;
+            auto ptr_holder = sid::get_origin(composite);
+            auto strides = sid::get_strides(composite);
+            for_each_block<BlockSizes, ThreadPool>(
+                sizes, [&, make_iterator = make_iterator()](auto const &block_indices) {
+                    auto offsets = block_offsets<BlockSizes>(block_indices);
+                    auto block_sizes = hymap::transform(block_sizes_f<BlockSizes, decltype(offsets)>{offsets}, sizes);
+                    auto ptr = ptr_holder();
+                    sid::shift(ptr, sid::get_stride<thread_dim>(strides), thread_pool::get_thread_num(ThreadPool()));
+                    sid::multi_shift(ptr,
+                        strides,
+                        hymap::convert_to<hymap::keys, meta::transform<sid::blocked_dim, dims_t>>(block_indices));
+                    tuple_util::for_each(
+                        [&](auto stage) {
+                            using extents_t = common::stage_extents<Args, decltype(stage)>;
+                            auto stage_ptr = ptr;
+                            sid::multi_shift(stage_ptr, strides, extents_t::offsets());
+                            common::make_loops(common::extended_sizes<extents_t>(block_sizes))(
+                                [&](auto ptr, auto const &strides) { decltype(stage)()(make_iterator, ptr, strides); })(
+                                std::move(stage_ptr), strides);
+                        },
+                        meta::rename<std::tuple, StageSpecs>());
+                });
+        }
+
+        // Local temporaries are allocated for the whole domain extended by their extents, all other sids are kept
+        template <class Allocator, class Sizes>
+        struct make_untiled_sid_f {
+            Allocator &m_alloc;
+            Sizes const &m_sizes;
+
+            template <class T, class Extents>
+            auto operator()(local_tmp<T, Extents>) const {
+                using namespace int_vector::arithmetic;
+                return sid::shift_sid_origin(
+                    allocate_global_tmp(m_alloc, common::extended_sizes<Extents>(m_sizes), data_type<T>()),
+                    -Extents::offsets());
+            }
+
+            template <class Sid>
+            Sid operator()(Sid const &sid) const {
+                return sid;
+            }
+        };
+
+        // All stages are executed one after another on the whole domain extended by the extents of their output
+        template <class Args,
+            class BlockSizes,
+            class ThreadPool,
+            class ColumnWidth,
+            class Sizes,
+            class StageSpecs,
+            class MakeIterator,
+            class Composite>
+        void apply_stencil_stages_untiled(cpu<BlockSizes, ThreadPool, ColumnWidth> be,
+            Sizes const &sizes,
+            StageSpecs,
+            MakeIterator const &make_iterator,
+            Composite &&composite) {
+            tuple_util::for_each(
+                [&](auto stage) {
+                    using extents_t = common::stage_extents<Args, decltype(stage)>;
+                    auto shifted = sid::shift_sid_origin(composite, extents_t::offsets());
+                    apply_stencil_stage(
+                        be, common::extended_sizes<extents_t>(sizes), std::move(stage), make_iterator, shifted);
+                },
+                meta::rename<std::tuple, StageSpecs>());
+        }
+
+        template <class Args>
+        struct is_global_arg_f {
+            template <class I>
+            using apply = std::negation<is_local_tmp<meta::at<Args, I>>>;
+        };
+
+        template <class Args, class Indices>
+        using global_args = meta::dedup<meta::filter<is_global_arg_f<Args>::template apply, Indices>>;
+
+        template <class Lhs, class Rhs>
+        using args_intersect = meta::any_of<meta::curry<meta::st_contains, Lhs>::template apply, Rhs>;
+
+        template <class Args, class Prev, class Stages>
+        struct is_tileable_impl : std::true_type {};
+
+        template <class Args, class... Prev, class Stage, class... Stages>
+        struct is_tileable_impl<Args, meta::list<Prev...>, meta::list<Stage, Stages...>>
+            : std::conjunction<
+                  std::negation<args_intersect<global_args<Args, meta::concat<typename Prev::outs_t...>>,
+                      typename Stage::ins_t>>,
+                  std::negation<args_intersect<global_args<Args, meta::concat<typename Prev::ins_t...>>,
+                      global_args<Args, typename Stage::outs_t>>>,
+                  is_tileable_impl<Args, meta::list<Prev..., Stage>, meta::list<Stages...>>> {};
+
+        /*
+         * As the shifts are only known at run time, the stages can be run tile by tile only if they pass data to each
+         * other through local temporaries exclusively: a stage that reads a sid written by a preceding stage could
+         * read the neighbouring tiles before they are computed, and a stage that writes a sid read by a preceding
+         * stage could overwrite them before they are read.
+         */
+        template <class Args, class StageSpecs>
+        using is_tileable =
+            is_tileable_impl<meta::rename<meta::list, Args>, meta::list<>, meta::rename<meta::list, StageSpecs>>;
+
+        /*
+         * If possible, the stages are executed tile by tile, such that the local temporaries are produced and
+         * consumed while they are still in cache. Otherwise they are executed one after another.
+         * The local temporaries are allocated per thread and tile, or for the whole domain, the other sids are blocked
+         * for the tiles.
+         */
+        template <class Args,
+            class BlockSizes,
+            class ThreadPool,
+            class ColumnWidth,
+            class Allocator,
+            class Sizes,
+            class StageSpecs,
+            class Arg>
+        auto make_stage_sid(cpu<BlockSizes, ThreadPool, ColumnWidth> const &,
+            Allocator &alloc,
+            Sizes const &sizes,
+            StageSpecs,
+            Arg &&arg) {
+            if constexpr (is_tileable<Args, StageSpecs>::value) {
+                using dims_t = blocked_dims<BlockSizes, Sizes>;
+                auto tile_sizes = hymap::transform(tile_sizes_f<BlockSizes, dims_t>(), sizes);
+                return make_tile_sid_f<BlockSizes, ThreadPool, dims_t, Allocator, decltype(tile_sizes)>{
+                    alloc, tile_sizes}(std::forward<Arg>(arg));
+            } else {
+                return make_untiled_sid_f<Allocator, Sizes>{alloc, sizes}(std::forward<Arg>(arg));
+            }
+        }
+
+        template <class Args,
+            class BlockSizes,
+            class ThreadPool,
+            class ColumnWidth,
+            class Sizes,
+            class StageSpecs,
+            class MakeIterator,
+            class Composite>
+        void apply_stencil_stages_on_tmps(cpu<BlockSizes, ThreadPool, ColumnWidth> be,
+            Sizes const &sizes,
+            StageSpecs,
+            MakeIterator const &make_iterator,
+            Composite &&composite) {
+            if constexpr (is_tileable<Args, StageSpecs>::value)
+                apply_stencil_stages_in_tiles<Args>(be, sizes, StageSpecs(), make_iterator, composite);
+            else
+                apply_stencil_stages_untiled<Args>(be, sizes, StageSpecs(), make_iterator, composite);
+        }
+
+        template <class BlockSizes,
+            class ThreadPool,
+            class ColumnWidth,
+            class Sizes,
+            class StageSpecs,
+            class MakeIterator,
+            class Sids>
+        void apply_stencil_stages_with_tmps(cpu<BlockSizes, ThreadPool, ColumnWidth> be,
+            Sizes const &sizes,
+            StageSpecs,
+            MakeIterator const &make_iterator,
+            Sids &&sids) {
+            using args_t = std::decay_t<Sids>;
+            auto alloc = tmp_allocator(be);
+            auto composite = common::make_composite(tuple_util::transform(
+                [&](auto &&arg) {
+                    return make_stage_sid<args_t>(be, alloc, sizes, StageSpecs(), std::forward<decltype(arg)>(arg));
+                },
+                std::forward<Sids>(sids)));
+            apply_stencil_stages_on_tmps<args_t>(be, sizes, StageSpecs(), make_iterator, composite);
+        }
+
+        template <class T, std::size_t... Is>
+        array<T, sizeof...(Is)> broadcast(T const &value, std::index_sequence<Is...>) {
+            return {(void(Is), value)...};
+        }
+
+        // The position in Dims of the dimension along which the sids of Keys have the smallest sum of absolute strides,
+        // the last one in case of a tie
+        template <class Dims, class Keys, class Strides>
+        int lane_dim_index(Strides const &strides) {
+            int res = 0;
+            long min_stride = 0;
+            for_each<meta::make_indices_for<Dims>>([&](auto i) {
+                using dim_t = meta::at<Dims, decltype(i)>;
+                long stride = 0;
+                for_each<Keys>([&](auto key) {
+                    auto const &element = sid::get_stride_element<decltype(key), dim_t>(strides);
+                    // strides that are not numbers (like those of positionals) do not address memory
+                    if constexpr (std::is_convertible_v<decltype(element), long>)
+                        stride += std::labs(long(element));
+                });
+                if (i == 0 || stride <= min_stride) {
+                    res = i;
+                    min_stride = stride;
+                }
+            });
+            return res;
+        }
+
+        template <int Width, class ColumnStage, class MakeIterator, class Seed>
+        struct column_block_f {
+            MakeIterator m_make_iterator;
+            Seed m_seed;
+            int m_v_size;
+            int m_lane_dim_index;
+
+            template <class LaneDim, class Ptr, class Strides, class BlockSizes>
+            void run_lanes(Ptr ptr, Strides const &strides, BlockSizes const &block_sizes) const {
+                int n = at_key<LaneDim>(block_sizes);
+                auto seeds = broadcast(m_seed, std::make_index_sequence<Width>());
+                common::make_loops(hymap::canonicalize_and_remove_key<LaneDim>(block_sizes))(
+                    [&](auto ptr, auto const &strides) {
+                        auto const &stride = sid::get_stride<LaneDim>(strides);
+                        int lane = 0;
+                        for (; lane + Width <= n; lane += Width) {
+                            ColumnStage().template lockstep<Width, LaneDim>(
+                                seeds, m_v_size, m_make_iterator, ptr, strides);
+                            sid::shift(ptr, stride, integral_constant<int, Width>());
+                        }
+                        for (; lane < n; ++lane) {
+                            ColumnStage()(m_seed, m_v_size, m_make_iterator, ptr, strides);
+                            sid::shift(ptr, stride, integral_constant<int, 1>());
+                        }
+                    })(std::move(ptr), strides);
+            }
+
+            template <class Ptr, class Strides, class BlockSizes>
+            void operator()(Ptr ptr, Strides const &strides, BlockSizes const &block_sizes) const {
+                using keys_t = get_keys<BlockSizes>;
+                if constexpr (Width == 1 || meta::is_empty<keys_t>::value) {
+                    common::make_loops(block_sizes)([&](auto ptr, auto const &strides) {
+                        ColumnStage()(m_seed, m_v_size, m_make_iterator, std::move(ptr), strides);
+                    })(std::move(ptr), strides);
+                } else {
+                    for_each<meta::make_indices_for<keys_t>>([&](auto i) {
+                        if (i == m_lane_dim_index)
+                            run_lanes<meta::at<keys_t, decltype(i)>>(ptr, strides, block_sizes);
+                    });
+                }
+            }
+        };
+
+        template <class BlockSizes,
+            class ThreadPool,
+            class ColumnWidth,
+            class Sizes,
+            class ColumnStage,
+            class MakeIterator,
+            class Composite,
+            class Vertical,
+            class Seed>
+        void apply_column_stage(cpu<BlockSizes, ThreadPool, ColumnWidth>,
+            Sizes const &sizes,
+            ColumnStage,
+            MakeIterator &&make_iterator,
+            Composite &&composite,
+            Vertical,
+            Seed seed) {
+            auto ptr_holder = sid::get_origin(std::forward<Composite>(composite));
+            auto strides = sid::get_strides(std::forward<Composite>(composite));
+            int v_size = at_key<Vertical>(sizes);
+            auto h_sizes = hymap::canonicalize_and_remove_key<Vertical>(sizes);
+            int lane_dim = lane_dim_index<get_keys<decltype(h_sizes)>, get_keys<std::decay_t<Composite>>>(strides);
+            parallel_for_blocks<BlockSizes, ThreadPool>(h_sizes,
+                ptr_holder,
+                strides,
+                column_block_f<ColumnWidth::value, ColumnStage, decltype(make_iterator()), Seed>{
+                    make_iterator(), std::move(seed), v_size, lane_dim});
+        }
+
+        template <class BlockSizes, class ThreadPool, class ColumnWidth>
+        auto tmp_allocator(cpu<BlockSizes, ThreadPool, ColumnWidth> be) {
+            return std::tuple(be, sid::cached_allocator(&std::make_unique<char[]>));
+        }
+
+        template <class BlockSizes, class ThreadPool, class ColumnWidth, class Allocator, class Sizes, class T>
+        auto allocate_global_tmp(
+            std::tuple<cpu<BlockSizes, ThreadPool, ColumnWidth>, Allocator> &alloc, Sizes const &sizes, data_type<T>) {
+            return sid::make_contiguous<T, int_t, sid::unknown_kind>(std::get<1>(alloc), sizes);
+        }
+    } // namespace cpu_impl_
+
+    using cpu_impl_::cpu;
+
+    using cpu_impl_::apply_column_stage;
+    using cpu_impl_::apply_stencil_stage;
+    using cpu_impl_::apply_stencil_stages_on_tmps;
+    using cpu_impl_::apply_stencil_stages_with_tmps;
+
+    using cpu_impl_::allocate_global_tmp;
+    using cpu_impl_::make_stage_sid;
+    using cpu_impl_::tmp_allocator;
+} // namespace gridtools::fn::backend
@@ -13,6 +13,7 @@
 #include <type_traits>
 #include <utility>
 
+#include "../common/array.hpp"
 #include "../common/functional.hpp"
 #include "../common/integral_constant.hpp"
 #include "../common/tuple.hpp"
@@ -32,6 +33,17 @@ namespace gridtools::fn {
         template <class T>
         using is_scan_pass = meta::is_instantiation_of<scan_pass, T>;
 
+        template <class F, std::size_t... Lanes>
+        GT_FUNCTION auto make_lanes_impl(F &&f, std::index_sequence<Lanes...>) {
+            return array<std::decay_t<decltype(f(0))>, sizeof...(Lanes)>{f(Lanes)...};
+        }
+
+        // Evaluates `f(lane)` for all lanes in increasing order and collects the results in an array
+        template <int Width, class F>
+        GT_FUNCTION auto make_lanes(F &&f) {
+            return make_lanes_impl(std::forward<F>(f), std::make_index_sequence<Width>());
+        }
+
         template <bool IsBackward>
         struct base : std::bool_constant<IsBackward> {
             static GT_FUNCTION constexpr auto prologue() { return tuple<>(); }
@@ -78,6 +90,54 @@ namespace gridtools::fn {
                     acc = next(std::move(acc), ScanOrFold::body());
                 return tuple_util::host_device::fold(next, std::move(acc), ScanOrFold::epilogue());
             }
+
+            /*
+             * Advances `Width` neighbouring columns along the horizontal dimension `Dim` in lockstep.
+             *
+             * `seeds` holds one seed per column, the result holds one accumulator per column.
+             * At every vertical level the innermost loop runs over the columns, so that loads and stores along `Dim`
+             * are issued back to back and the column loop can be vectorized by the compiler.
+             */
+            template <int Width, class Dim, class Seeds, class MakeIterator, class Ptr, class Strides>
+            GT_FUNCTION auto lockstep(
+                Seeds seeds, std::size_t size, MakeIterator &&make_iterator, Ptr ptr, Strides const &strides) const {
+                static_assert(Width > 0);
+                constexpr std::size_t prologue_size = std::tuple_size_v<decltype(ScanOrFold::prologue())>;
+                constexpr std::size_t epilogue_size = std::tuple_size_v<decltype(ScanOrFold::epilogue())>;
+                assert(size >= prologue_size + epilogue_size);
+                using step_t = integral_constant<int, ScanOrFold::value ? -1 : 1>;
+                auto const &v_stride = sid::get_stride<Vertical>(strides);
+                auto const &h_stride = sid::get_stride<Dim>(strides);
+                auto inc = [&] { sid::shift(ptr, v_stride, step_t()); };
+                auto next = [&](auto accs, auto pass) {
+                    auto res = make_lanes<Width>([&](int lane) {
+                        auto lane_ptr = sid::shifted(ptr, h_stride, lane);
+                        if constexpr (is_scan_pass<decltype(pass)>()) {
+                            // scan
+                            auto res = pass.m_f(std::move(accs[lane]),
+                                make_iterator(integral_constant<int, Ins>(), lane_ptr, strides)...);
+                            *host_device::at_key<integral_constant<int, Out>>(lane_ptr) = pass.m_p(res);
+                            return res;
+                        } else {
+                            // fold
+                            return pass(std::move(accs[lane]),
+                                make_iterator(integral_constant<int, Ins>(), lane_ptr, strides)...);
+                        }
+                        // disable incorrect warning "missing return statement at end of non-void function"
+                        GT_NVCC_DIAG_PUSH_SUPPRESS(940)
+                    });
+                    GT_NVCC_DIAG_POP_SUPPRESS(940)
+                    inc();
+                    return res;
+                };
+                if constexpr (ScanOrFold::value)
+                    sid::shift(ptr, v_stride, size - 1);
+                auto accs = tuple_util::host_device::fold(next, std::move(seeds), ScanOrFold::prologue());
+                std::size_t n = size - prologue_size - epilogue_size;
+                for (std::size_t i = 0; i < n; ++i)
+                    accs = next(std::move(accs), ScanOrFold::body());
+                return tuple_util::host_device::fold(next, std::move(accs), ScanOrFold::epilogue());
+            }
         };
 
         template <class... ColumnStages>
@@ -92,6 +152,18 @@ namespace gridtools::fn {
                     std::move(seed),
                     tuple(ColumnStages()...));
             }
+
+            template <int Width, class Dim, class Seeds, class MakeIterator, class Ptr, class Strides>
+            GT_FUNCTION auto lockstep(
+                Seeds seeds, std::size_t size, MakeIterator &&make_iterator, Ptr ptr, Strides const &strides) const {
+                return tuple_util::host_device::fold(
+                    [&](auto accs, auto stage) {
+                        return stage.template lockstep<Width, Dim>(
+                            std::move(accs), size, std::forward<MakeIterator>(make_iterator), ptr, strides);
+                    },
+                    std::move(seeds),
+                    tuple(ColumnStages()...));
+            }
         };
     } // namespace column_stage_impl_
 
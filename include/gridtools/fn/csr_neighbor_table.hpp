@@ -0,0 +1,64 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cassert>
+#include <type_traits>
+
+#include "../common/array.hpp"
+#include "../common/host_device.hpp"
+#include "./neighbor_table.hpp"
+
+namespace gridtools::fn {
+    namespace csr_neighbor_table_impl_ {
+        /*
+         * Compressed sparse row neighbor table for meshes with varying number of neighbors.
+         *
+         * The neighbors of `index` are `indices[offsets[index]]`, ..., `indices[offsets[index + 1] - 1]`,
+         * hence `offsets` has one element more than there are rows. MaxNeighbors is only used to model the
+         * fixed-size neighbor table concept, iteration with `neighbor_table::for_each_neighbor` only reads the
+         * stored neighbors. No row may have more than MaxNeighbors neighbors, this is asserted in
+         * `neighbor_table_neighbors`. The table does not own the memory.
+         */
+        template <int MaxNeighbors, class Index = int>
+        struct csr_neighbor_table {
+            static_assert(std::is_integral_v<Index>);
+
+            Index const *m_offsets;
+            Index const *m_indices;
+
+            friend GT_FUNCTION int neighbor_table_num_neighbors(csr_neighbor_table const &table, int index) {
+                return table.m_offsets[index + 1] - table.m_offsets[index];
+            }
+
+            friend GT_FUNCTION Index neighbor_table_neighbor(csr_neighbor_table const &table, int index, int i) {
+                return table.m_indices[table.m_offsets[index] + i];
+            }
+
+            friend GT_FUNCTION array<Index, MaxNeighbors> neighbor_table_neighbors(
+                csr_neighbor_table const &table, int index) {
+                array<Index, MaxNeighbors> res;
+                int n = neighbor_table_num_neighbors(table, index);
+                assert(n <= MaxNeighbors);
+                for (int i = 0; i < MaxNeighbors; ++i)
+                    res[i] = i < n ? neighbor_table_neighbor(table, index, i) : -1;
+                return res;
+            }
+        };
+
+        template <int MaxNeighbors, class Index>
+        csr_neighbor_table<MaxNeighbors, Index> make_csr_neighbor_table(Index const *offsets, Index const *indices) {
+            return {offsets, indices};
+        }
+    } // namespace csr_neighbor_table_impl_
+
+    using csr_neighbor_table_impl_::csr_neighbor_table;
+    using csr_neighbor_table_impl_::make_csr_neighbor_table;
+} // namespace gridtools::fn
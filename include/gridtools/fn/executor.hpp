@@ -9,17 +9,101 @@
  */
 #pragma once
 
+#include <optional>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 
+#include "../common/hymap.hpp"
+#include "../common/integral_constant.hpp"
 #include "../common/tuple_util.hpp"
 #include "../meta.hpp"
+#include "../sid/concept.hpp"
 #include "../sid/sid_shift_origin.hpp"
+#include "../sid/synthetic.hpp"
+#include "./backend/common.hpp"
 #include "./column_stage.hpp"
+#include "./extents.hpp"
 #include "./run.hpp"
 #include "./stencil_stage.hpp"
 
 namespace gridtools::fn {
     namespace executor_impl_ {
+        template <class Key, class Target, class Composite, class Sid>
+        decltype(auto) sid_or_replacement(Composite const &composite, Sid &sid) {
+            if constexpr (std::is_same_v<Key, Target>)
+                return std::move(sid);
+            else
+                return at_key<Key>(composite);
+        }
+
+        template <class Target, class Composite, class Sid, class... Keys>
+        Composite replace_sid(Composite const &composite, Sid &&sid, meta::list<Keys...>) {
+            return {sid_or_replacement<Keys, Target>(composite, sid)...};
+        }
+
+        /*
+         * The persistent state of a plan: the local temporaries are allocated once with `Allocator`, which is owned by
+         * the plan, and the composite of the shifted args and its strides are computed only once.
+         * `Args` are the args with the temporary placeholders, with `Specs` they determine how the backend lays out
+         * and runs the stages, see `make_stage_sid` and `apply_stencil_stages_on_tmps`.
+         */
+        template <int ArgOffset,
+            class Backend,
+            class Sizes,
+            class Offsets,
+            class MakeIterator,
+            class Args,
+            class Specs,
+            class Allocator,
+            class Composite>
+        struct plan_data {
+            using args_t = Args;
+            using has_local_tmps = meta::any_of<backend::is_local_tmp, meta::rename<meta::list, Args>>;
+
+            Backend m_backend;
+            Sizes m_sizes;
+            Offsets m_offsets;
+            MakeIterator m_make_iterator;
+            Allocator m_alloc;
+            std::optional<Composite> m_composite;
+            sid::strides_type<Composite> m_strides = sid::get_strides(*m_composite);
+
+            // The sid that stands for the shifted arg in the composite
+            template <class Arg>
+            auto stage_sid(Arg &&arg) {
+                if constexpr (has_local_tmps::value)
+                    return make_stage_sid<Args>(m_backend, m_alloc, m_sizes, Specs(), std::forward<Arg>(arg));
+                else
+                    return std::decay_t<Arg>(std::forward<Arg>(arg));
+            }
+
+            // The composite with the cached strides, only the origin is taken from the args
+            auto cached_sid() {
+                using sid::property;
+                return sid::synthetic()
+                    .set<property::origin>(sid::get_origin(*m_composite))
+                    .template set<property::strides>(m_strides)
+                    .template set<property::ptr_diff, sid::ptr_diff_type<Composite>>()
+                    .template set<property::strides_kind, sid::strides_kind<Composite>>();
+            }
+
+            // Replaces the I-th user argument by a sid of the same type, other args are kept as they are
+            template <class I, class Arg>
+            void rebind(I, Arg &&arg) {
+                using key_t = integral_constant<int, I::value + ArgOffset>;
+                static_assert(!backend::is_local_tmp<meta::at_c<Args, I::value + ArgOffset>>::value,
+                    "temporaries can not be rebound");
+                Composite composite = replace_sid<key_t>(*m_composite,
+                    stage_sid(sid::shift_sid_origin(std::forward<Arg>(arg), m_offsets)),
+                    meta::rename<meta::list, get_keys<Composite>>());
+                // shifted sids may hold references, hence no assignment
+                m_composite.reset();
+                m_composite.emplace(std::move(composite));
+                m_strides = sid::get_strides(*m_composite);
+            }
+        };
+
         template <class Backend,
             int ArgOffset,
             class Sizes,
@@ -35,6 +119,7 @@ namespace gridtools::fn {
             Args m_args = {};
             using arg_offset_t = std::integral_constant<int, ArgOffset>;
             using specs_t = Specs;
+            using has_local_tmps = meta::any_of<backend::is_local_tmp, meta::rename<meta::list, Args>>;
 
             template <class Arg>
             auto arg(Arg &&arg) && {
@@ -48,6 +133,44 @@ namespace gridtools::fn {
                     std::move(args)};
             }
 
+            // Temporaries are placed in the arg list as they are: they are relative to the domain, not to the sids
+            template <class T, class Extents>
+            auto tmp() && {
+                auto args = tuple_util::deep_copy(
+                    tuple_util::push_back(std::move(m_args), backend::local_tmp<T, Extents>()));
+                return executor_data<Backend, ArgOffset, Sizes, Offsets, MakeIterator, decltype(args), Specs>{
+                    std::move(m_backend),
+                    std::move(m_sizes),
+                    std::move(m_offsets),
+                    std::move(m_make_iterator),
+                    std::move(args)};
+            }
+
+            template <class Allocator = std::tuple<>>
+            auto bake(Allocator alloc = {}) && {
+                auto composite = [&] {
+                    if constexpr (has_local_tmps::value)
+                        return make_stage_composite(m_backend, alloc, m_sizes, Specs(), std::move(m_args));
+                    else
+                        return make_composite(std::move(m_args));
+                }();
+                using plan_data_t = plan_data<ArgOffset,
+                    Backend,
+                    Sizes,
+                    Offsets,
+                    MakeIterator,
+                    Args,
+                    Specs,
+                    Allocator,
+                    decltype(composite)>;
+                return plan_data_t{std::move(m_backend),
+                    std::move(m_sizes),
+                    std::move(m_offsets),
+                    std::move(m_make_iterator),
+                    std::move(alloc),
+                    std::move(composite)};
+            }
+
             template <class Spec>
             auto spec(Spec) && {
                 using specs_t = meta::push_back<Specs, Spec>;
@@ -60,16 +183,70 @@ namespace gridtools::fn {
             }
         };
 
+        template <class Specs, class PlanData>
+        struct stencil_plan {
+            PlanData m_data;
+
+            template <class I, class Arg>
+            stencil_plan &rebind(I, Arg &&arg) {
+                m_data.rebind(I(), std::forward<Arg>(arg));
+                return *this;
+            }
+
+            void execute() {
+                if constexpr (PlanData::has_local_tmps::value)
+                    apply_stencil_stages_on_tmps<typename PlanData::args_t>(
+                        m_data.m_backend, m_data.m_sizes, Specs(), m_data.m_make_iterator, m_data.cached_sid());
+                else
+                    run_stencil_stages_on_composite(m_data.m_backend,
+                        fuse_stencil_stages<Specs>(),
+                        m_data.m_make_iterator,
+                        m_data.m_sizes,
+                        m_data.cached_sid());
+            }
+        };
+
+        template <class Vertical, class Specs, class PlanData, class Seeds>
+        struct vertical_plan {
+            PlanData m_data;
+            Seeds m_seeds;
+
+            template <class I, class Arg>
+            vertical_plan &rebind(I, Arg &&arg) {
+                m_data.rebind(I(), std::forward<Arg>(arg));
+                return *this;
+            }
+
+            void execute() {
+                run_column_stages_on_composite(m_data.m_backend,
+                    Specs(),
+                    m_data.m_make_iterator,
+                    m_data.m_sizes,
+                    Vertical(),
+                    m_data.cached_sid(),
+                    m_seeds);
+            }
+        };
+
         template <class Data>
         struct stencil_executor {
             Data m_data;
 
+            // The args must not alias each other, the stages are fused based on the arg indices.
             template <class Arg>
             auto arg(Arg &&arg) && {
                 auto data = std::move(m_data).arg(std::forward<Arg>(arg));
                 return stencil_executor<decltype(data)>{std::move(data)};
             }
 
+            // Adds a temporary of type T, stages writing it are computed on the domain extended by Extents.
+            // Backends may allocate it per tile such that it stays in cache.
+            template <class T, class Extents = extents<>>
+            auto tmp(Extents = {}) && {
+                auto data = std::move(m_data).template tmp<T, Extents>();
+                return stencil_executor<decltype(data)>{std::move(data)};
+            }
+
             template <class Out, class Stencil, class... Ins>
             auto assign(Out, Stencil, Ins...) && {
                 auto data = std::move(m_data).spec(stencil_stage<Stencil,
@@ -78,12 +255,29 @@ namespace gridtools::fn {
                 return stencil_executor<decltype(data)>{std::move(data)};
             }
 
+            // Bakes the executor into a plan that can be executed many times.
+            // The temporaries are allocated once per plan with `alloc`, which is owned by the plan.
+            template <class Allocator>
+            auto plan(Allocator alloc) && {
+                auto data = std::move(m_data).bake(std::move(alloc));
+                return stencil_plan<typename Data::specs_t, decltype(data)>{std::move(data)};
+            }
+
+            auto plan() && { return std::move(*this).plan(tmp_allocator(m_data.m_backend)); }
+
             void execute() && {
-                run_stencil_stages(std::move(m_data.m_backend),
-                    typename Data::specs_t(),
-                    std::move(m_data.m_make_iterator),
-                    std::move(m_data.m_sizes),
-                    std::move(m_data.m_args));
+                if constexpr (Data::has_local_tmps::value)
+                    run_stencil_stages_with_tmps(std::move(m_data.m_backend),
+                        typename Data::specs_t(),
+                        std::move(m_data.m_make_iterator),
+                        std::move(m_data.m_sizes),
+                        std::move(m_data.m_args));
+                else
+                    run_stencil_stages(std::move(m_data.m_backend),
+                        fuse_stencil_stages<typename Data::specs_t>(),
+                        std::move(m_data.m_make_iterator),
+                        std::move(m_data.m_sizes),
+                        std::move(m_data.m_args));
             }
         };
 
@@ -108,6 +302,13 @@ namespace gridtools::fn {
                 return vertical_executor<Vertical, decltype(data), decltype(seeds)>{std::move(data), std::move(seeds)};
             }
 
+            // Bakes the executor into a plan that can be executed many times
+            auto plan() && {
+                using specs_t = typename Data::specs_t;
+                auto data = std::move(m_data).bake();
+                return vertical_plan<Vertical, specs_t, decltype(data), Seeds>{std::move(data), std::move(m_seeds)};
+            }
+
             void execute() && {
                 run_column_stages(std::move(m_data.m_backend),
                     typename Data::specs_t(),
@@ -11,8 +11,11 @@
 
 #include <type_traits>
 
+#include "../common/tuple.hpp"
 #include "../common/tuple_util.hpp"
 #include "../meta/logical.hpp"
+#include "../meta/make_indices.hpp"
+#include "../meta/rename.hpp"
 
 /**
  *   Basic API for the neighbor table concept.
@@ -27,10 +30,20 @@
  *
  *   Pure functional behavior without side-effects is expected from the provided function.
  *
+ *   Compressed neighbor tables, where the number of neighbors varies per index, additionally define
+ *     `int neighbor_table_num_neighbors(T const&, int index);`
+ *     `Index neighbor_table_neighbor(T const&, int index, int i);`
+ *   returning the number of valid neighbors and the i-th of them. Their `Neighbors` are padded with `-1`.
+ *
+ *   Dense neighbor tables, where no neighbor is missing, additionally define
+ *     `std::true_type neighbor_table_is_dense(T const&);`
+ *   Users typically get them by wrapping a table known to be full with `neighbor_table::dense`.
+ *
  *   Compile-time API
  *   ================
  *
  *   `neighbor_table::is_neighbor_table<T>`: predicate that checks if T models the neighbor table concept.
+ *   `neighbor_table::is_dense_neighbor_table<T>`: predicate that checks if T is known to have no missing neighbors.
  *
  *   Run-time API
  *   ============
@@ -39,6 +52,17 @@
  *
  *   `Neighbors neighbor_table::neighbors(NeighborTable const&, int);`
  *
+ *   Iteration over the valid neighbors (the ones that are not `-1`), calling `f(neighbor, i)`:
+ *
+ *   `void neighbor_table::for_each_neighbor(NeighborTable const&, int, F&& f);`
+ *
+ *   For compressed neighbor tables, the loop runs exactly over the stored neighbors. For dense tables, the `-1`
+ *   checks are omitted.
+ *
+ *   Declaration of a table without missing neighbors, the result is a dense neighbor table:
+ *
+ *   `dense_neighbor_table<NeighborTable> neighbor_table::dense(NeighborTable const&);`
+ *
  *   Default Implementation
  *   ======================
  *
@@ -76,8 +100,69 @@ namespace gridtools::fn::neighbor_table {
         struct is_neighbor_table<T, std::enable_if_t<is_neighbor_list<neighbor_list_type<T>>::value>> : std::true_type {
         };
 
+        template <class T, class = void>
+        struct is_compressed_neighbor_table : std::false_type {};
+
+        template <class T>
+        struct is_compressed_neighbor_table<T,
+            std::enable_if_t<std::is_integral_v<decltype(neighbor_table_num_neighbors(std::declval<T const &>(), 0))> &&
+                             std::is_integral_v<decltype(neighbor_table_neighbor(std::declval<T const &>(), 0, 0))>>>
+            : std::true_type {};
+
+        template <class T, class = void>
+        struct is_dense_neighbor_table : std::false_type {};
+
+        template <class T>
+        struct is_dense_neighbor_table<T,
+            std::enable_if_t<decltype(neighbor_table_is_dense(std::declval<T const &>()))::value>> : std::true_type {};
+
+        template <class NeighborTable>
+        struct dense_neighbor_table {
+            static_assert(!is_compressed_neighbor_table<NeighborTable>::value);
+
+            NeighborTable m_table;
+
+            friend GT_FUNCTION constexpr decltype(auto) neighbor_table_neighbors(
+                dense_neighbor_table const &table, int index) {
+                return neighbor_table_impl_::neighbors(table.m_table, index);
+            }
+
+            friend std::true_type neighbor_table_is_dense(dense_neighbor_table const &) { return {}; }
+        };
+
+        template <class NeighborTable>
+        dense_neighbor_table<NeighborTable> dense(NeighborTable const &nt) {
+            static_assert(is_neighbor_table<NeighborTable>::value);
+            return {nt};
+        }
+
+        template <class NeighborTable, class F>
+        GT_FUNCTION void for_each_neighbor(NeighborTable const &nt, int index, F &&f) {
+            if constexpr (is_compressed_neighbor_table<NeighborTable>::value) {
+                int n = neighbor_table_num_neighbors(nt, index);
+                for (int i = 0; i < n; ++i)
+                    f(neighbor_table_neighbor(nt, index, i), i);
+            } else {
+                decltype(auto) neighbors = neighbor_table_impl_::neighbors(nt, index);
+                using indices_t = meta::make_indices<tuple_util::size<neighbor_list_type<NeighborTable>>, tuple>;
+                tuple_util::host_device::for_each(
+                    [&](auto i) {
+                        auto neighbor = tuple_util::host_device::get<decltype(i)::value>(neighbors);
+                        if constexpr (is_dense_neighbor_table<NeighborTable>::value)
+                            f(neighbor, int(i));
+                        else if (neighbor != -1)
+                            f(neighbor, int(i));
+                    },
+                    indices_t());
+            }
+        }
     } // namespace neighbor_table_impl_
 
+    using neighbor_table_impl_::dense;
+    using neighbor_table_impl_::dense_neighbor_table;
+    using neighbor_table_impl_::for_each_neighbor;
+    using neighbor_table_impl_::is_compressed_neighbor_table;
+    using neighbor_table_impl_::is_dense_neighbor_table;
     using neighbor_table_impl_::is_neighbor_table;
     using neighbor_table_impl_::neighbors;
 
@@ -0,0 +1,265 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../common/array.hpp"
+#include "../common/tuple_util.hpp"
+#include "./neighbor_table.hpp"
+
+/**
+ *   Renumbering of unstructured meshes for better locality of the neighbor accesses.
+ *
+ *   A permutation is a `std::vector<int> perm` with `perm[new_index] == old_index`.
+ *
+ *   Orderings
+ *   =========
+ *
+ *   `morton_order(points)`, `hilbert_order(points)`: space-filling curve orderings of the locations, given their
+ *   coordinates (e.g. cell centers) as a random access range of tuple-likes. The Hilbert curve is two-dimensional.
+ *
+ *   `reverse_cuthill_mckee(table, size)`: bandwidth reducing ordering of a graph given as neighbor table that maps a
+ *   location type to itself (like v2v).
+ *
+ *   Applying Permutations
+ *   =====================
+ *
+ *   `permute_neighbor_table(table, perm, target_perm)`: reorders the rows of the neighbor table by `perm` and renumbers
+ *   the neighbors according to `target_perm`, the permutation of the target location type. The result is a
+ *   `std::vector` of neighbor lists, its `data()` models the neighbor table concept.
+ *
+ *   `permute_initializer(perm, init)`: wraps a storage initializer, such that the storage is built in the new order.
+ *
+ *   `permute_data_store(perm, src, dst)` and `unpermute_data_store(perm, src, dst)` copy fields into and out of the new
+ *   order, the first dimension of the data stores is the horizontal one. The data stores have to be host accessible.
+ */
+namespace gridtools::fn::renumbering {
+    namespace renumbering_impl_ {
+        inline std::vector<int> inverse(std::vector<int> const &perm) {
+            std::vector<int> res(perm.size());
+            for (std::size_t i = 0; i != perm.size(); ++i)
+                res[perm[i]] = i;
+            return res;
+        }
+
+        template <class Keys>
+        std::vector<int> sorted_by(Keys const &keys) {
+            std::vector<int> res(keys.size());
+            std::iota(res.begin(), res.end(), 0);
+            std::stable_sort(res.begin(), res.end(), [&](int l, int r) { return keys[l] < keys[r]; });
+            return res;
+        }
+
+        template <class Point, std::size_t... Is>
+        array<double, sizeof...(Is)> to_array(Point const &point, std::index_sequence<Is...>) {
+            return {double(tuple_util::get<Is>(point))...};
+        }
+
+        // Maps the coordinates to integers in [0, 2^Bits) within the bounding box of the points
+        template <int Bits, class Points>
+        auto quantize(Points const &points) {
+            using point_t = std::decay_t<decltype(*std::begin(points))>;
+            constexpr std::size_t dims = tuple_util::size<point_t>::value;
+            std::vector<array<double, dims>> coords;
+            for (auto const &point : points)
+                coords.push_back(to_array(point, std::make_index_sequence<dims>()));
+
+            array<double, dims> lo, hi;
+            for (std::size_t d = 0; d != dims; ++d) {
+                lo[d] = std::numeric_limits<double>::max();
+                hi[d] = std::numeric_limits<double>::lowest();
+            }
+            for (auto const &c : coords)
+                for (std::size_t d = 0; d != dims; ++d) {
+                    lo[d] = std::min(lo[d], c[d]);
+                    hi[d] = std::max(hi[d], c[d]);
+                }
+
+            constexpr std::uint64_t max_value = (std::uint64_t(1) << Bits) - 1;
+            std::vector<array<std::uint64_t, dims>> res;
+            res.reserve(coords.size());
+            for (auto const &c : coords) {
+                array<std::uint64_t, dims> q;
+                for (std::size_t d = 0; d != dims; ++d)
+                    q[d] = hi[d] > lo[d] ? std::uint64_t((c[d] - lo[d]) / (hi[d] - lo[d]) * max_value) : 0;
+                res.push_back(q);
+            }
+            return res;
+        }
+
+        template <class Points>
+        std::vector<int> morton_order(Points const &points) {
+            using point_t = std::decay_t<decltype(*std::begin(points))>;
+            constexpr int dims = tuple_util::size<point_t>::value;
+            constexpr int bits = 63 / dims;
+            auto quantized = quantize<bits>(points);
+            std::vector<std::uint64_t> codes;
+            codes.reserve(quantized.size());
+            for (auto const &q : quantized) {
+                std::uint64_t code = 0;
+                // the first dimension varies fastest
+                for (int b = bits - 1; b >= 0; --b)
+                    for (int d = dims - 1; d >= 0; --d)
+                        code = code << 1 | (q[d] >> b & 1);
+                codes.push_back(code);
+            }
+            return sorted_by(codes);
+        }
+
+        template <class Points>
+        std::vector<int> hilbert_order(Points const &points) {
+            using point_t = std::decay_t<decltype(*std::begin(points))>;
+            static_assert(tuple_util::size<point_t>::value == 2, "hilbert ordering is only implemented in 2D");
+            constexpr int bits = 31;
+            auto quantized = quantize<bits>(points);
+            std::vector<std::uint64_t> codes;
+            codes.reserve(quantized.size());
+            for (auto const &q : quantized) {
+                std::uint64_t x = q[0], y = q[1], code = 0;
+                for (std::uint64_t s = std::uint64_t(1) << (bits - 1); s > 0; s /= 2) {
+                    std::uint64_t rx = (x & s) > 0;
+                    std::uint64_t ry = (y & s) > 0;
+                    code += s * s * ((3 * rx) ^ ry);
+                    // rotate the quadrant
+                    if (ry == 0) {
+                        if (rx == 1) {
+                            x = s - 1 - (x & (s - 1));
+                            y = s - 1 - (y & (s - 1));
+                        }
+                        std::swap(x, y);
+                    }
+                }
+                codes.push_back(code);
+            }
+            return sorted_by(codes);
+        }
+
+        template <class NeighborTable>
+        std::vector<int> reverse_cuthill_mckee(NeighborTable const &table, int size) {
+            std::vector<int> degrees(size);
+            for (int i = 0; i != size; ++i)
+                neighbor_table::for_each_neighbor(table, i, [&](int, int) { ++degrees[i]; });
+            auto by_degree = [&](int l, int r) { return degrees[l] < degrees[r]; };
+
+            // every connected component is started from its node of minimal degree
+            std::vector<int> res;
+            res.reserve(size);
+            std::vector<bool> visited(size, false);
+            for (int start : sorted_by(degrees)) {
+                if (visited[start])
+                    continue;
+                visited[start] = true;
+                res.push_back(start);
+                for (std::size_t head = res.size() - 1; head != res.size(); ++head) {
+                    auto first = res.size();
+                    neighbor_table::for_each_neighbor(table, res[head], [&](int neighbor, int) {
+                        assert(neighbor >= 0 && neighbor < size);
+                        if (!visited[neighbor]) {
+                            visited[neighbor] = true;
+                            res.push_back(neighbor);
+                        }
+                    });
+                    std::stable_sort(res.begin() + first, res.end(), by_degree);
+                }
+            }
+            std::reverse(res.begin(), res.end());
+            return res;
+        }
+
+        template <class NeighborTable>
+        auto permute_neighbor_table(
+            NeighborTable const &table, std::vector<int> const &perm, std::vector<int> const &target_perm) {
+            using neighbors_t = std::decay_t<decltype(neighbor_table::neighbors(table, 0))>;
+            auto target_inv = inverse(target_perm);
+            std::vector<neighbors_t> res;
+            res.reserve(perm.size());
+            for (int old_index : perm) {
+                neighbors_t neighbors = neighbor_table::neighbors(table, old_index);
+                tuple_util::for_each(
+                    [&](auto &neighbor) {
+                        if (neighbor != -1)
+                            neighbor = target_inv[neighbor];
+                    },
+                    neighbors);
+                res.push_back(neighbors);
+            }
+            return res;
+        }
+
+        template <class Initializer>
+        auto permute_initializer(std::vector<int> perm, Initializer init) {
+            return [perm = std::move(perm), init = std::move(init)](int index, auto... indices) {
+                return init(perm[index], indices...);
+            };
+        }
+
+        // Calls `f(index)` for all multi-indices of the view
+        template <class View, class F>
+        void for_each_index(View const &view, F const &f) {
+            auto lengths = view.lengths();
+            constexpr std::size_t ndims = tuple_util::size<decltype(lengths)>::value;
+            std::size_t total = 1;
+            for (auto length : lengths)
+                total *= length;
+            for (std::size_t flat = 0; flat != total; ++flat) {
+                array<int, ndims> index;
+                std::size_t rest = flat;
+                for (std::size_t d = ndims; d-- != 0;) {
+                    index[d] = rest % lengths[d];
+                    rest /= lengths[d];
+                }
+                f(index);
+            }
+        }
+
+        template <class Src, class Dst>
+        void permute_data_store(std::vector<int> const &perm, Src const &src, Dst const &dst) {
+            auto src_view = src->const_host_view();
+            auto dst_view = dst->host_view();
+            assert(dst_view.lengths()[0] == perm.size());
+            for_each_index(dst_view, [&](auto const &index) {
+                auto src_index = index;
+                src_index[0] = perm[index[0]];
+                dst_view(index) = src_view(src_index);
+            });
+        }
+
+        template <class Src, class Dst>
+        void unpermute_data_store(std::vector<int> const &perm, Src const &src, Dst const &dst) {
+            auto src_view = src->const_host_view();
+            auto dst_view = dst->host_view();
+            assert(src_view.lengths()[0] == perm.size());
+            for_each_index(src_view, [&](auto const &index) {
+                auto dst_index = index;
+                dst_index[0] = perm[index[0]];
+                dst_view(dst_index) = src_view(index);
+            });
+        }
+    } // namespace renumbering_impl_
+
+    using renumbering_impl_::hilbert_order;
+    using renumbering_impl_::inverse;
+    using renumbering_impl_::morton_order;
+    using renumbering_impl_::permute_data_store;
+    using renumbering_impl_::permute_initializer;
+    using renumbering_impl_::permute_neighbor_table;
+    using renumbering_impl_::reverse_cuthill_mckee;
+    using renumbering_impl_::unpermute_data_store;
+} // namespace gridtools::fn::renumbering
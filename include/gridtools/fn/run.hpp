@@ -9,45 +9,138 @@
  */
 #pragma once
 
+#include <type_traits>
+#include <utility>
+
+#include "../common/int_vector.hpp"
 #include "../common/tuple_util.hpp"
 #include "../meta.hpp"
 #include "../sid/composite.hpp"
+#include "../sid/sid_shift_origin.hpp"
+#include "./backend/common.hpp"
+#include "./extents.hpp"
 #include "./stencil_stage.hpp"
 
 namespace gridtools::fn {
     namespace run_impl_ {
-        template <class Sids>
-        auto make_composite(Sids &&sids) {
-            using keys_t = meta::iseq_to_list<std::make_integer_sequence<int, std::tuple_size_v<Sids>>,
-                sid::composite::keys,
-                integral_constant>;
-            return tuple_util::convert_to<keys_t::template values>(std::forward<Sids>(sids));
+        using backend::common::make_composite;
+
+        template <class Backend, class StageSpecs, class MakeIterator, class Domain, class Composite>
+        void run_stencil_stages_on_composite(Backend const &backend,
+            StageSpecs,
+            MakeIterator const &make_iterator,
+            Domain const &domain,
+            Composite &&composite) {
+            tuple_util::for_each(
+                [&](auto stage) { apply_stencil_stage(backend, domain, std::move(stage), make_iterator, composite); },
+                meta::rename<std::tuple, StageSpecs>());
         }
 
         template <class Backend, class StageSpecs, class MakeIterator, class Domain, class Sids>
         void run_stencil_stages(
             Backend const &backend, StageSpecs, MakeIterator const &make_iterator, Domain const &domain, Sids &&sids) {
-            auto composite = make_composite(std::forward<Sids>(sids));
+            run_stencil_stages_on_composite(
+                backend, StageSpecs(), make_iterator, domain, make_composite(std::forward<Sids>(sids)));
+        }
+
+        template <class Allocator, class Domain>
+        struct make_global_tmp_f {
+            Allocator &m_alloc;
+            Domain const &m_domain;
+
+            template <class T, class Extents>
+            auto operator()(backend::local_tmp<T, Extents>) const {
+                using namespace int_vector::arithmetic;
+                return sid::shift_sid_origin(
+                    allocate_global_tmp(
+                        m_alloc, backend::common::extended_sizes<Extents>(m_domain), backend::data_type<T>()),
+                    -Extents::offsets());
+            }
+
+            template <class Sid>
+            Sid operator()(Sid const &sid) const {
+                return sid;
+            }
+        };
+
+        /*
+         * Backends that support local temporaries overload the following two functions, the fallbacks allocate them as
+         * global temporaries covering the extended domain. `Args` are the sids with the `backend::local_tmp`
+         * placeholders.
+         *
+         * The sid that stands for `arg` in the composite passed to `apply_stencil_stages_on_tmps`: the placeholders are
+         * allocated with `alloc`, the other sids are kept.
+         */
+        template <class Args, class Backend, class Allocator, class Domain, class StageSpecs, class Arg>
+        auto make_stage_sid(Backend const &, Allocator &alloc, Domain const &domain, StageSpecs, Arg &&arg) {
+            return make_global_tmp_f<Allocator, Domain>{alloc, domain}(std::forward<Arg>(arg));
+        }
+
+        // Runs every stage on the domain extended by its extents
+        template <class Args, class Backend, class Domain, class StageSpecs, class MakeIterator, class Composite>
+        void apply_stencil_stages_on_tmps(Backend const &backend,
+            Domain const &domain,
+            StageSpecs,
+            MakeIterator const &make_iterator,
+            Composite &&composite) {
             tuple_util::for_each(
-                [&](auto stage) { apply_stencil_stage(backend, domain, std::move(stage), make_iterator, composite); },
+                [&](auto stage) {
+                    using extents_t = backend::common::stage_extents<Args, decltype(stage)>;
+                    auto shifted = sid::shift_sid_origin(composite, extents_t::offsets());
+                    apply_stencil_stage(backend,
+                        backend::common::extended_sizes<extents_t>(domain),
+                        std::move(stage),
+                        make_iterator,
+                        shifted);
+                },
                 meta::rename<std::tuple, StageSpecs>());
         }
 
+        // The composite of the sids that stand for `args`, see `make_stage_sid`
+        template <class Args, class Backend, class Allocator, class Domain, class StageSpecs>
+        auto make_stage_composite(
+            Backend const &backend, Allocator &alloc, Domain const &domain, StageSpecs, Args &&args) {
+            return make_composite(tuple_util::transform(
+                [&](auto &&arg) {
+                    return make_stage_sid<std::decay_t<Args>>(
+                        backend, alloc, domain, StageSpecs(), std::forward<decltype(arg)>(arg));
+                },
+                std::forward<Args>(args)));
+        }
+
+        // Backends may overload it, the fallback allocates the temporaries per call
+        template <class Backend, class Domain, class StageSpecs, class MakeIterator, class Sids>
+        void apply_stencil_stages_with_tmps(
+            Backend const &backend, Domain const &domain, StageSpecs, MakeIterator const &make_iterator, Sids &&sids) {
+            auto alloc = tmp_allocator(backend);
+            apply_stencil_stages_on_tmps<std::decay_t<Sids>>(backend,
+                domain,
+                StageSpecs(),
+                make_iterator,
+                make_stage_composite(backend, alloc, domain, StageSpecs(), std::forward<Sids>(sids)));
+        }
+
+        // Runs stencil stages where some of the sids are `backend::local_tmp` placeholders
+        template <class Backend, class StageSpecs, class MakeIterator, class Domain, class Sids>
+        void run_stencil_stages_with_tmps(
+            Backend const &backend, StageSpecs, MakeIterator const &make_iterator, Domain const &domain, Sids &&sids) {
+            apply_stencil_stages_with_tmps(backend, domain, StageSpecs(), make_iterator, std::forward<Sids>(sids));
+        }
+
         template <class Backend,
             class StageSpecs,
             class MakeIterator,
             class Domain,
             class Vertical,
-            class Sids,
+            class Composite,
             class Seeds>
-        void run_column_stages(Backend const &backend,
+        void run_column_stages_on_composite(Backend const &backend,
             StageSpecs,
             MakeIterator const &make_iterator,
             Domain const &domain,
             Vertical,
-            Sids &&sids,
+            Composite &&composite,
             Seeds &&seeds) {
-            auto composite = make_composite(std::forward<Sids>(sids));
             tuple_util::for_each(
                 [&](auto stage, auto seed) {
                     apply_column_stage(
@@ -56,8 +149,38 @@ namespace gridtools::fn {
                 meta::rename<std::tuple, StageSpecs>(),
                 std::forward<Seeds>(seeds));
         }
+
+        template <class Backend,
+            class StageSpecs,
+            class MakeIterator,
+            class Domain,
+            class Vertical,
+            class Sids,
+            class Seeds>
+        void run_column_stages(Backend const &backend,
+            StageSpecs,
+            MakeIterator const &make_iterator,
+            Domain const &domain,
+            Vertical,
+            Sids &&sids,
+            Seeds &&seeds) {
+            run_column_stages_on_composite(backend,
+                StageSpecs(),
+                make_iterator,
+                domain,
+                Vertical(),
+                make_composite(std::forward<Sids>(sids)),
+                std::forward<Seeds>(seeds));
+        }
     } // namespace run_impl_
 
+    using run_impl_::apply_stencil_stages_on_tmps;
+    using run_impl_::make_composite;
+    using run_impl_::make_stage_composite;
+    using run_impl_::make_stage_sid;
     using run_impl_::run_column_stages;
+    using run_impl_::run_column_stages_on_composite;
     using run_impl_::run_stencil_stages;
+    using run_impl_::run_stencil_stages_on_composite;
+    using run_impl_::run_stencil_stages_with_tmps;
 } // namespace gridtools::fn
@@ -9,27 +9,88 @@
  */
 #pragma once
 
+#include <type_traits>
+
 #include "../common/hymap.hpp"
 #include "../common/integral_constant.hpp"
 #include "../common/tuple_util.hpp"
+#include "../meta.hpp"
 
 namespace gridtools::fn {
+    namespace stencil_stage_impl_ {
+        template <class Stencil, int Out, int... Ins>
+        struct stencil_stage {
+            using outs_t = meta::list<integral_constant<int, Out>>;
+            using ins_t = meta::list<integral_constant<int, Ins>...>;
+
+            template <class MakeIterator, class Ptr, class Strides>
+            GT_FUNCTION void operator()(MakeIterator &&make_iterator, Ptr &ptr, Strides const &strides) const {
+                *host_device::at_key<integral_constant<int, Out>>(ptr) =
+                    Stencil()()(make_iterator(integral_constant<int, Ins>(), ptr, strides)...);
+            }
+        };
+
+        template <class... Stages>
+        struct merged_stencil_stage {
+            using outs_t = meta::concat<typename Stages::outs_t...>;
+            using ins_t = meta::concat<typename Stages::ins_t...>;
+
+            template <class MakeIterator, class Ptr, class Strides>
+            GT_FUNCTION void operator()(MakeIterator &&make_iterator, Ptr &ptr, Strides const &strides) const {
+                (Stages()(std::forward<MakeIterator>(make_iterator), ptr, strides), ...);
+            }
+        };
+
+        template <class Lhs, class Rhs>
+        using intersects = meta::any_of<meta::curry<meta::st_contains, meta::dedup<Lhs>>::template apply, Rhs>;
+
+        // As the shifts are only known at run time, a stage is considered to be independent from a group of stages
+        // only if it does not read any output of the group and does not write to any input of the group.
+        template <class Group, class Stage>
+        using is_independent = std::negation<std::disjunction<intersects<typename Group::outs_t, typename Stage::ins_t>,
+            intersects<typename Group::ins_t, typename Stage::outs_t>>>;
+
+        template <class Groups, class Stage>
+        struct add_stage {
+            using last_t = meta::last<Groups>;
+            using type = std::conditional_t<is_independent<last_t, Stage>::value,
+                meta::push_back<meta::pop_back<Groups>, meta::push_back<last_t, Stage>>,
+                meta::push_back<Groups, merged_stencil_stage<Stage>>>;
+        };
+
+        template <class Stage>
+        struct add_stage<meta::list<>, Stage> {
+            using type = meta::list<merged_stencil_stage<Stage>>;
+        };
+
+        template <class Groups, class Stage>
+        using add_stage_t = typename add_stage<Groups, Stage>::type;
+
+        template <class Group>
+        struct unwrap_group {
+            using type = Group;
+        };
+
+        template <class Stage>
+        struct unwrap_group<merged_stencil_stage<Stage>> {
+            using type = Stage;
+        };
+
+        template <class Group>
+        using unwrap_group_t = typename unwrap_group<Group>::type;
 
-    template <class Stencil, int Out, int... Ins>
-    struct stencil_stage {
-        template <class MakeIterator, class Ptr, class Strides>
-        GT_FUNCTION void operator()(MakeIterator &&make_iterator, Ptr &ptr, Strides const &strides) const {
-            *host_device::at_key<integral_constant<int, Out>>(ptr) =
-                Stencil()()(make_iterator(integral_constant<int, Ins>(), ptr, strides)...);
-        }
-    };
-
-    template <class... Stages>
-    struct merged_stencil_stage {
-        template <class MakeIterator, class Ptr, class Strides>
-        GT_FUNCTION void operator()(MakeIterator &&make_iterator, Ptr &ptr, Strides const &strides) const {
-            (Stages()(std::forward<MakeIterator>(make_iterator), ptr, strides), ...);
-        }
-    };
+        /*
+         * Fuses consecutive independent stages into `merged_stencil_stage`s, so that they are executed within a single
+         * pass over the domain. The order of execution within a merged stage is the order of the original stages.
+         *
+         * The independence is decided on the arg indices only, hence the sids bound to different args must not alias.
+         */
+        template <class Stages>
+        using fuse_stencil_stages =
+            meta::transform<unwrap_group_t, meta::foldl<add_stage_t, meta::list<>, meta::rename<meta::list, Stages>>>;
+    } // namespace stencil_stage_impl_
 
+    using stencil_stage_impl_::fuse_stencil_stages;
+    using stencil_stage_impl_::merged_stencil_stage;
+    using stencil_stage_impl_::stencil_stage;
 } // namespace gridtools::fn
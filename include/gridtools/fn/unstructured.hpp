@@ -61,7 +61,11 @@ namespace gridtools::fn {
             return domain_with_offsets(hymap::concat(conns...), sizes, offsets);
         };
 
-        template <class Tag, class Ptr, class Strides, class Domain>
+        /*
+         * `Valid` is true if the index is known at compile time not to be `-1`. That is the case for iterators that
+         * were only shifted along dense connectivities, their `can_deref` and `shift` do not need to check the index.
+         */
+        template <class Tag, class Ptr, class Strides, class Domain, bool Valid = true>
         struct iterator {
             Ptr m_ptr;
             Strides const &m_strides;
@@ -69,40 +73,51 @@ namespace gridtools::fn {
             int m_index;
         };
 
-        template <class Tag, class Ptr, class Strides, class Domain>
-        GT_FUNCTION constexpr bool can_deref(iterator<Tag, Ptr, Strides, Domain> const &it) {
-            return it.m_index != -1;
+        template <class Tag, class Ptr, class Strides, class Domain, bool Valid>
+        GT_FUNCTION constexpr bool can_deref(iterator<Tag, Ptr, Strides, Domain, Valid> const &it) {
+            return Valid || it.m_index != -1;
         }
 
-        template <class Tag, class Ptr, class Strides, class Domain>
-        GT_FUNCTION constexpr auto deref(iterator<Tag, Ptr, Strides, Domain> const &it) {
+        template <class Tag, class Ptr, class Strides, class Domain, bool Valid>
+        GT_FUNCTION constexpr auto deref(iterator<Tag, Ptr, Strides, Domain, Valid> const &it) {
             assert(can_deref(it));
             decltype(auto) stride = host_device::at_key<Tag>(sid::get_stride<dim::horizontal>(it.m_strides));
             return *sid::shifted(it.m_ptr, stride, it.m_index);
         }
 
-        template <class Tag, class Ptr, class Strides, class Domain, class Conn, class Offset>
-        GT_FUNCTION constexpr auto horizontal_shift(iterator<Tag, Ptr, Strides, Domain> const &it, Conn, Offset) {
+        template <class Tag, class Ptr, class Strides, class Domain, bool Valid, class Conn, class Offset>
+        GT_FUNCTION constexpr auto horizontal_shift(
+            iterator<Tag, Ptr, Strides, Domain, Valid> const &it, Conn, Offset) {
             auto const &table = host_device::at_key<Conn>(it.m_domain.m_tables);
-            auto new_index = get<Offset::value>(neighbor_table::neighbors(table, it.m_index));
-            auto shifted = it;
-            shifted.m_index = new_index;
-            return shifted;
+            constexpr bool dense = neighbor_table::is_dense_neighbor_table<std::decay_t<decltype(table)>>::value;
+            return iterator<Tag, Ptr, Strides, Domain, Valid && dense>{it.m_ptr,
+                it.m_strides,
+                it.m_domain,
+                int(get<Offset::value>(neighbor_table::neighbors(table, it.m_index)))};
         }
 
-        template <class Tag, class Ptr, class Strides, class Domain, class Dim, class Offset>
+        template <class Tag, class Ptr, class Strides, class Domain, bool Valid, class Dim, class Offset>
         GT_FUNCTION constexpr auto non_horizontal_shift(
-            iterator<Tag, Ptr, Strides, Domain> const &it, Dim, Offset offset) {
+            iterator<Tag, Ptr, Strides, Domain, Valid> const &it, Dim, Offset offset) {
             auto shifted = it;
             sid::shift(shifted.m_ptr, host_device::at_key<Tag>(sid::get_stride<Dim>(shifted.m_strides)), offset);
             return shifted;
         }
 
-        template <class Tag, class Ptr, class Strides, class Domain, class Dim, class Offset, class... Offsets>
+        template <class Tag,
+            class Ptr,
+            class Strides,
+            class Domain,
+            bool Valid,
+            class Dim,
+            class Offset,
+            class... Offsets>
         GT_FUNCTION constexpr auto shift(
-            iterator<Tag, Ptr, Strides, Domain> const &it, Dim, Offset offset, Offsets... offsets) {
-            if (it.m_index == -1)
-                return it;
+            iterator<Tag, Ptr, Strides, Domain, Valid> const &it, Dim, Offset offset, Offsets... offsets) {
+            // a possibly invalid iterator stays possibly invalid, hence both branches return the same type
+            if constexpr (!Valid)
+                if (it.m_index == -1)
+                    return it;
 
             if constexpr (has_key<decltype(it.m_domain.m_tables), Dim>()) {
                 return shift(horizontal_shift(it, Dim(), offset), offsets...);
@@ -110,11 +125,80 @@ namespace gridtools::fn {
                 return shift(non_horizontal_shift(it, Dim(), offset), offsets...);
             }
         }
-        template <class Tag, class Ptr, class Strides, class Domain>
-        GT_FUNCTION constexpr auto shift(iterator<Tag, Ptr, Strides, Domain> const &it) {
+        template <class Tag, class Ptr, class Strides, class Domain, bool Valid>
+        GT_FUNCTION constexpr auto shift(iterator<Tag, Ptr, Strides, Domain, Valid> const &it) {
             return it;
         }
 
+        // Calls `f(shifted_it, i)` for all valid neighbors of `it` along the connectivity Conn
+        template <class Tag, class Ptr, class Strides, class Domain, bool Valid, class Conn, class F>
+        GT_FUNCTION void for_each_neighbor(iterator<Tag, Ptr, Strides, Domain, Valid> const &it, Conn, F &&f) {
+            if constexpr (!Valid)
+                if (it.m_index == -1)
+                    return;
+            auto const &table = host_device::at_key<Conn>(it.m_domain.m_tables);
+            neighbor_table::for_each_neighbor(table, it.m_index, [&](int neighbor, int i) {
+                // the neighbors passed here are never `-1`
+                f(iterator<Tag, Ptr, Strides, Domain>{it.m_ptr, it.m_strides, it.m_domain, neighbor}, i);
+            });
+        }
+
+        // Elementwise arithmetic on possibly tuple-valued field values, the accumulators are kept per component
+        template <class T>
+        GT_FUNCTION constexpr auto zero() {
+            if constexpr (tuple_util::is_tuple_like<T>::value)
+                return tuple_util::host_device::transform(
+                    [](auto const &x) { return zero<std::decay_t<decltype(x)>>(); }, T());
+            else
+                return T(0);
+        }
+
+        template <class T, class U>
+        GT_FUNCTION constexpr auto add(T const &lhs, U const &rhs) {
+            if constexpr (tuple_util::is_tuple_like<T>::value)
+                return tuple_util::host_device::transform(
+                    [](auto const &l, auto const &r) { return add(l, r); }, lhs, rhs);
+            else
+                return lhs + rhs;
+        }
+
+        template <class W, class T>
+        GT_FUNCTION constexpr auto scale(W const &weight, T const &value) {
+            if constexpr (tuple_util::is_tuple_like<T>::value)
+                return tuple_util::host_device::transform([&](auto const &x) { return scale(weight, x); }, value);
+            else
+                return weight * value;
+        }
+
+        // Folds `acc = f(acc, deref(neighbor), i)` over all valid neighbors of `it` along the connectivity Conn
+        template <class Tag, class Ptr, class Strides, class Domain, bool Valid, class Conn, class F, class Init>
+        GT_FUNCTION constexpr auto reduce(
+            iterator<Tag, Ptr, Strides, Domain, Valid> const &it, Conn, F &&f, Init init) {
+            for_each_neighbor(it, Conn(), [&](auto const &neighbor, int i) { init = f(init, deref(neighbor), i); });
+            return init;
+        }
+
+        // Sum of the values of all valid neighbors of `it` along the connectivity Conn, computed componentwise
+        template <class Tag, class Ptr, class Strides, class Domain, bool Valid, class Conn>
+        GT_FUNCTION constexpr auto sum_over(iterator<Tag, Ptr, Strides, Domain, Valid> const &it, Conn) {
+            // tuples of references (like from structure of arrays fields) are accumulated as tuples of values
+            using value_t = std::decay_t<decltype(add(deref(it), deref(it)))>;
+            return reduce(
+                it, Conn(), [](auto const &acc, auto const &value, int) { return add(acc, value); }, zero<value_t>());
+        }
+
+        // Weighted sum, `weights[i]` is the weight of the i-th neighbor
+        template <class Tag, class Ptr, class Strides, class Domain, bool Valid, class Conn, class Weights>
+        GT_FUNCTION constexpr auto sum_over(
+            iterator<Tag, Ptr, Strides, Domain, Valid> const &it, Conn, Weights const &weights) {
+            using value_t = std::decay_t<decltype(scale(weights[0], deref(it)))>;
+            return reduce(
+                it,
+                Conn(),
+                [&](auto const &acc, auto const &value, int i) { return add(acc, scale(weights[i], value)); },
+                zero<value_t>());
+        }
+
         template <class Domain>
         struct make_iterator {
             Domain m_domain;
@@ -10,9 +10,12 @@
 #pragma once
 
 #include <algorithm>
+#include <cmath>
 #include <type_traits>
+#include <vector>
 
 #include "../common/defs.hpp"
+#include "../common/host_device.hpp"
 #include "functions.hpp"
 
 namespace gridtools {
@@ -71,6 +74,28 @@ namespace gridtools {
             return res;
         }
 
+        template <class Acc, class RowFun, class Merge>
+        Acc reduction_reduce_rows(cpu, size_t num_rows, Acc const &init, RowFun const &row_fun, Merge const &merge) {
+            Acc res = init;
+#pragma omp parallel
+            {
+                Acc acc = init;
+#pragma omp for nowait
+                for (size_t row = 0; row < num_rows; ++row)
+                    row_fun(acc, row);
+#pragma omp critical
+                res = merge(res, acc);
+            }
+            return res;
+        }
+
+        template <class F>
+        void reduction_parallel_for(cpu, size_t size, F const &f) {
+#pragma omp parallel for
+            for (size_t i = 0; i < size; ++i)
+                f(i);
+        }
+
         inline size_t reduction_round_size(cpu, size_t size) { return size; }
         inline size_t reduction_allocation_size(cpu, size_t size) { return size; }
 
@@ -82,5 +107,162 @@ namespace gridtools {
             }
             std::fill(ptr, ptr + rounded_size, val);
         }
+
+        /**
+         *   Reproducible CPU reductions.
+         *
+         *   The buffer is cut into chunks of a fixed size, each chunk is reduced with a fixed number of lanes that are
+         *   combined pairwise, and the partial results of the chunks are combined with a pairwise tree as well. The
+         *   shape of the computation depends only on the size of the buffer, hence the result is the same bit for bit
+         *   for any number of threads. With `cpu_reproducible<neumaier>` the floating point sums carry a Neumaier
+         *   (improved Kahan) compensation term, other functors and integral types are not affected. The compensation
+         *   is only available for plain reductions, fused and partial reductions are rejected at compile time.
+         *
+         *   Note that unlike `cpu`, the initial value is used to initialize every lane, it has to be the neutral
+         *   element of the functor, which is the case for the values stored in `reducible`.
+         */
+        struct neumaier {};
+
+        template <class Compensation = void>
+        struct cpu_reproducible {};
+
+        namespace cpu_reproducible_impl_ {
+            constexpr size_t chunk_size = 4096;
+            constexpr size_t lanes = 8;
+
+            template <class F, class T>
+            struct plain_acc {
+                using value_t = T;
+
+                static value_t init(T const &val) { return val; }
+                static GT_FORCE_INLINE value_t add(value_t const &acc, T const &val) { return F()(acc, val); }
+                static GT_FORCE_INLINE value_t merge(value_t const &lhs, value_t const &rhs) { return F()(lhs, rhs); }
+                static T result(value_t const &acc) { return acc; }
+            };
+
+            template <class T>
+            struct compensated {
+                T sum;
+                T error;
+            };
+
+            template <class T>
+            struct neumaier_acc {
+                using value_t = compensated<T>;
+
+                static value_t init(T const &val) { return {val, 0}; }
+
+                static GT_FORCE_INLINE value_t add(value_t const &acc, T const &val) {
+                    T sum = acc.sum + val;
+                    T error = std::abs(acc.sum) >= std::abs(val) ? (acc.sum - sum) + val : (val - sum) + acc.sum;
+                    return {sum, acc.error + error};
+                }
+
+                static GT_FORCE_INLINE value_t merge(value_t const &lhs, value_t const &rhs) {
+                    value_t res = add(lhs, rhs.sum);
+                    res.error += rhs.error;
+                    return res;
+                }
+
+                static T result(value_t const &acc) { return acc.sum + acc.error; }
+            };
+
+            template <class Compensation, class F, class T>
+            struct get_acc {
+                using type = plain_acc<F, T>;
+            };
+
+            template <class T>
+            struct get_acc<neumaier, plus, T> {
+                using type = std::conditional_t<std::is_floating_point_v<T>, neumaier_acc<T>, plain_acc<plus, T>>;
+            };
+
+            // pairwise combination of `vals[0], ..., vals[n - 1]` into `vals[0]`
+            template <class V, class Merge>
+            GT_FORCE_INLINE void tree_reduce(V *vals, size_t n, Merge const &merge) {
+                for (size_t stride = 1; stride < n; stride *= 2)
+                    for (size_t i = 0; i + stride < n; i += 2 * stride)
+                        vals[i] = merge(vals[i], vals[i + stride]);
+            }
+
+            template <class Acc, class T>
+            typename Acc::value_t reduce_chunk(typename Acc::value_t const &init, T const *buff, size_t n) {
+                typename Acc::value_t lane[lanes];
+                for (size_t j = 0; j != lanes; ++j)
+                    lane[j] = init;
+                size_t i = 0;
+                for (; i + lanes <= n; i += lanes) {
+#pragma omp simd
+                    for (size_t j = 0; j < lanes; ++j)
+                        lane[j] = Acc::add(lane[j], buff[i + j]);
+                }
+                for (size_t j = 0; i != n; ++i, ++j)
+                    lane[j] = Acc::add(lane[j], buff[i]);
+                tree_reduce(lane, lanes, &Acc::merge);
+                return lane[0];
+            }
+        } // namespace cpu_reproducible_impl_
+
+        template <class Compensation, class F, class T>
+        T reduction_reduce(cpu_reproducible<Compensation>, T res, F, T const *buff, size_t n) {
+            static_assert(std::is_empty<F>(), "Reproducible reduction supports only stateless functors.");
+            using cpu_reproducible_impl_::chunk_size;
+            using acc_t = typename cpu_reproducible_impl_::get_acc<Compensation, F, T>::type;
+            if (n == 0)
+                return res;
+            auto init = acc_t::init(res);
+            size_t num_chunks = (n + chunk_size - 1) / chunk_size;
+            std::vector<typename acc_t::value_t> partials(num_chunks, init);
+#pragma omp parallel for
+            for (size_t c = 0; c < num_chunks; ++c)
+                partials[c] = cpu_reproducible_impl_::reduce_chunk<acc_t>(
+                    init, buff + c * chunk_size, std::min(chunk_size, n - c * chunk_size));
+            cpu_reproducible_impl_::tree_reduce(partials.data(), num_chunks, &acc_t::merge);
+            return acc_t::result(partials[0]);
+        }
+
+        // the rows are reduced separately and combined with a pairwise tree
+        template <class Compensation, class Acc, class RowFun, class Merge>
+        Acc reduction_reduce_rows(cpu_reproducible<Compensation>,
+            size_t num_rows,
+            Acc const &init,
+            RowFun const &row_fun,
+            Merge const &merge) {
+            static_assert(std::is_void_v<Compensation>,
+                "Compensated reproducible reductions support only plain reductions, not fused or partial ones.");
+            if (num_rows == 0)
+                return init;
+            std::vector<Acc> partials(num_rows, init);
+#pragma omp parallel for
+            for (size_t row = 0; row < num_rows; ++row)
+                row_fun(partials[row], row);
+            cpu_reproducible_impl_::tree_reduce(partials.data(), num_rows, merge);
+            return partials[0];
+        }
+
+        template <class Compensation, class F>
+        void reduction_parallel_for(cpu_reproducible<Compensation>, size_t size, F const &f) {
+            reduction_parallel_for(cpu(), size, f);
+        }
+
+        template <class Compensation>
+        size_t reduction_round_size(cpu_reproducible<Compensation>, size_t size) {
+            return size;
+        }
+
+        template <class Compensation>
+        size_t reduction_allocation_size(cpu_reproducible<Compensation>, size_t size) {
+            return size;
+        }
+
+        template <class Compensation, class T>
+        void reduction_fill(cpu_reproducible<Compensation>,
+            T const &val,
+            T *ptr,
+            size_t data_size,
+            size_t rounded_size,
+            bool has_holes) {
+            reduction_fill(cpu(), val, ptr, data_size, rounded_size, has_holes);
+        }
     } // namespace reduction
 } // namespace gridtools
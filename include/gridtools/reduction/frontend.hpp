@@ -9,17 +9,24 @@
  */
 #pragma once
 
+#include <array>
 #include <cassert>
 #include <cstdlib>
 #include <memory>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
+#include "../common/for_each.hpp"
 #include "../common/tuple.hpp"
 #include "../common/tuple_util.hpp"
 #include "../meta.hpp"
 #include "../sid/allocator.hpp"
 #include "../storage/traits.hpp"
+#include "functions.hpp"
+#include "fused.hpp"
+#include "location.hpp"
+#include "partial.hpp"
 
 namespace gridtools {
     namespace reduction {
@@ -32,7 +39,14 @@ namespace gridtools {
             template <class Sizes>
             using zeros_type = decltype(zeros(std::declval<Sizes const &>()));
 
-            template <class Backend, class T, class Origin, class Strides, class StridesKind, class Sizes>
+            // `StorageTraits` are the traits of the buffer, `partial_reduce` allocates its result with them
+            template <class Backend,
+                class T,
+                class Origin,
+                class Strides,
+                class StridesKind,
+                class Sizes,
+                class StorageTraits = void>
             struct reducible {
                 std::shared_ptr<void> m_alloc;
                 T neutral_value;
@@ -47,24 +61,61 @@ namespace gridtools {
                     return reduction_reduce(Backend(), neutral_value, f, m_origin(), m_size);
                 }
 
+                // evaluates all the functors in a single pass over the buffer, returns the tuple of the results
+                template <class... Fs>
+                auto reduce(tuple<Fs...> funs) const {
+                    return tuple_util::get<0>(fused_reduce(funs, *this));
+                }
+
                 friend Strides sid_get_strides(reducible const &obj) { return obj.m_strides; }
                 friend Origin sid_get_origin(reducible const &obj) { return {obj.m_origin}; }
                 friend zeros_type<Sizes> sid_get_lower_bounds(reducible const &obj) { return zeros(obj.m_sizes); }
                 friend Sizes sid_get_upper_bounds(reducible const &obj) { return obj.m_sizes; }
             };
 
-            template <class Backend, class T, class Origin, class Strides, class StridesKind, class Sizes>
-            StridesKind sid_get_strides_kind(reducible<Backend, T, Origin, Strides, StridesKind, Sizes> const &);
+            template <class Backend,
+                class T,
+                class Origin,
+                class Strides,
+                class StridesKind,
+                class Sizes,
+                class StorageTraits>
+            StridesKind sid_get_strides_kind(
+                reducible<Backend, T, Origin, Strides, StridesKind, Sizes, StorageTraits> const &);
+
+            /**
+             *   Evaluates all the functors of `funs` on all the reducibles in a single pass. The reducibles must have
+             *   the same sizes. Returns a tuple (per reducible) of tuples (per functor) of the results.
+             */
+            template <class Funs,
+                class Backend,
+                class T,
+                class Origin,
+                class Strides,
+                class StridesKind,
+                class Sizes,
+                class StorageTraits,
+                class... Reducibles>
+            auto fused_reduce(Funs funs,
+                reducible<Backend, T, Origin, Strides, StridesKind, Sizes, StorageTraits> const &first,
+                Reducibles const &...rest) {
+                auto sizes = tuple_util::convert_to<std::array, int_t>(first.m_sizes);
+                assert(((tuple_util::convert_to<std::array, int_t>(rest.m_sizes) == sizes) && ...));
+                return fused_impl_::reduce(Backend(),
+                    funs,
+                    sizes,
+                    fused_impl_::make_input(first.m_origin(), first.m_strides),
+                    fused_impl_::make_input(rest.m_origin(), rest.m_strides)...);
+            }
 
             template <class StorageTraits>
             struct alloc_fun {
                 auto operator()(size_t size) const { return storage::traits::allocate<StorageTraits, char>(size); }
             };
 
-            template <class Backend, class StorageTraits, class Id = void, class T, class... Dims>
-            auto make_reducible(T const &neutral_value, Dims... dims) {
+            template <class Backend, class StorageTraits, class Id, class T, class Lengths>
+            auto make_reducible_from_lengths(T const &neutral_value, Lengths lengths) {
                 sid::host_device::cached_allocator<alloc_fun<StorageTraits>> alloc;
-                auto lengths = tuple(dims...);
                 auto info = storage::traits::make_info<StorageTraits, T>(lengths);
                 auto strides = info.native_strides();
                 size_t data_size = info.length();
@@ -81,15 +132,138 @@ namespace gridtools {
                     T,
                     decltype(origin),
                     decltype(strides),
-                    storage::traits::strides_kind<StorageTraits, T, decltype(lengths), Id>,
-                    decltype(lengths)>{std::make_shared<decltype(alloc)>(std::move(alloc)),
+                    storage::traits::strides_kind<StorageTraits, T, Lengths, Id>,
+                    Lengths,
+                    StorageTraits>{std::make_shared<decltype(alloc)>(std::move(alloc)),
                     neutral_value,
                     std::move(origin),
                     rounded_size,
                     std::move(strides),
                     std::move(lengths)};
             }
+
+            template <class Backend, class StorageTraits, class Id = void, class T, class... Dims>
+            auto make_reducible(T const &neutral_value, Dims... dims) {
+                return make_reducible_from_lengths<Backend, StorageTraits, Id>(neutral_value, tuple(dims...));
+            }
+
+            template <int... Dims>
+            struct is_reduced_f {
+                template <class I>
+                using apply = std::bool_constant<((I::value == Dims) || ...)>;
+            };
+
+            template <template <class...> class L, class... Is, class Sizes>
+            auto select_lengths(L<Is...>, Sizes const &sizes) {
+                return tuple(tuple_util::get<Is::value>(sizes)...);
+            }
+
+            /**
+             *   Reduces the dimensions `Dims` of `src` with `f`. The result is a new `reducible` with the same backend
+             *   and storage traits over the remaining dimensions, in their original order.
+             *
+             *   Example: the vertical sum of a 3D field `r`: `partial_reduce<2>(plus(), r)`
+             */
+            template <int... Dims,
+                class F,
+                class Backend,
+                class T,
+                class Origin,
+                class Strides,
+                class StridesKind,
+                class Sizes,
+                class StorageTraits>
+            auto partial_reduce(
+                F f, reducible<Backend, T, Origin, Strides, StridesKind, Sizes, StorageTraits> const &src) {
+                static_assert(!std::is_void_v<StorageTraits>, "partial_reduce needs the storage traits of the buffer");
+                constexpr size_t n = tuple_util::size<Sizes>::value;
+                static_assert(sizeof...(Dims) > 0 && ((Dims >= 0 && Dims < int(n)) && ...), "invalid dimensions");
+                using kept_t = meta::filter<meta::not_<is_reduced_f<Dims...>::template apply>::template apply,
+                    meta::make_indices_c<n>>;
+                static_assert(meta::length<kept_t>::value > 0, "use reduce() to reduce all the dimensions");
+                auto res = make_reducible_from_lengths<Backend, StorageTraits, void>(
+                    src.neutral_value, select_lengths(kept_t(), src.m_sizes));
+                auto res_strides = tuple_util::convert_to<std::array, int_t>(res.m_strides);
+                std::array<int_t, n> out_strides = {};
+                std::array<bool, n> reduced;
+                reduced.fill(true);
+                size_t pos = 0;
+                for_each<kept_t>([&](auto i) {
+                    reduced[i.value] = false;
+                    out_strides[i.value] = res_strides[pos++];
+                });
+                partial_impl_::reduce(Backend(),
+                    f,
+                    reduced,
+                    tuple_util::convert_to<std::array, int_t>(src.m_sizes),
+                    src.m_origin(),
+                    tuple_util::convert_to<std::array, int_t>(src.m_strides),
+                    res.m_origin(),
+                    out_strides);
+                return res;
+            }
+
+            /**
+             *   The smallest element of `src` and its indices, see `location.hpp`.
+             */
+            template <class Backend,
+                class T,
+                class Origin,
+                class Strides,
+                class StridesKind,
+                class Sizes,
+                class StorageTraits>
+            location<T, tuple_util::size<Sizes>::value> argmin(
+                reducible<Backend, T, Origin, Strides, StridesKind, Sizes, StorageTraits> const &src) {
+                return location_impl_::arg_reduce<min>(Backend(),
+                    tuple_util::convert_to<std::array, int_t>(src.m_sizes),
+                    fused_impl_::make_input(src.m_origin(), src.m_strides));
+            }
+
+            /**
+             *   The largest element of `src` and its indices, see `location.hpp`.
+             */
+            template <class Backend,
+                class T,
+                class Origin,
+                class Strides,
+                class StridesKind,
+                class Sizes,
+                class StorageTraits>
+            location<T, tuple_util::size<Sizes>::value> argmax(
+                reducible<Backend, T, Origin, Strides, StridesKind, Sizes, StorageTraits> const &src) {
+                return location_impl_::arg_reduce<max>(Backend(),
+                    tuple_util::convert_to<std::array, int_t>(src.m_sizes),
+                    fused_impl_::make_input(src.m_origin(), src.m_strides));
+            }
+
+            /**
+             *   The `k` best elements of `src` and their indices, best first. `F` is `min` for the smallest and `max`
+             *   for the largest elements.
+             *
+             *   Example: the five largest values of `r`: `top_k(max(), 5, r)`
+             */
+            template <class F,
+                class Backend,
+                class T,
+                class Origin,
+                class Strides,
+                class StridesKind,
+                class Sizes,
+                class StorageTraits>
+            std::vector<location<T, tuple_util::size<Sizes>::value>> top_k(
+                F, size_t k, reducible<Backend, T, Origin, Strides, StridesKind, Sizes, StorageTraits> const &src) {
+                return location_impl_::top_k<F>(Backend(),
+                    k,
+                    tuple_util::convert_to<std::array, int_t>(src.m_sizes),
+                    fused_impl_::make_input(src.m_origin(), src.m_strides));
+            }
         } // namespace frontend_impl_
+        using frontend_impl_::argmax;
+        using frontend_impl_::argmin;
+        using frontend_impl_::fused_reduce;
         using frontend_impl_::make_reducible;
+        using frontend_impl_::partial_reduce;
+        using frontend_impl_::top_k;
     } // namespace reduction
 } // namespace gridtools
@@ -9,51 +9,108 @@
  */
 #pragma once
 
+#include <limits>
+
 #include "../common/host_device.hpp"
 
 namespace gridtools {
     namespace reduction {
         struct plus {
+            template <class T>
+            static constexpr T neutral() {
+                return T(0);
+            }
+
             template <class T>
             GT_FUNCTION auto operator()(T const &x, T const &y) const {
                 return x + y;
             }
         };
         struct mul {
+            template <class T>
+            static constexpr T neutral() {
+                return T(1);
+            }
+
             template <class T>
             GT_FUNCTION auto operator()(T const &x, T const &y) const {
                 return x * y;
             }
         };
         struct min {
+            template <class T>
+            static constexpr T neutral() {
+                using limits_t = std::numeric_limits<T>;
+                return limits_t::has_infinity ? limits_t::infinity() : limits_t::max();
+            }
+
             template <class T>
             GT_FUNCTION auto operator()(T const &x, T const &y) const {
                 return x < y ? x : y;
             }
         };
         struct max {
+            template <class T>
+            static constexpr T neutral() {
+                using limits_t = std::numeric_limits<T>;
+                return limits_t::has_infinity ? -limits_t::infinity() : limits_t::lowest();
+            }
+
             template <class T>
             GT_FUNCTION auto operator()(T const &x, T const &y) const {
                 return x > y ? x : y;
             }
         };
         struct bitwise_and {
+            template <class T>
+            static constexpr T neutral() {
+                return ~T(0);
+            }
+
             template <class T>
             GT_FUNCTION auto operator()(T const &x, T const &y) const {
                 return x & y;
             }
         };
         struct bitwise_or {
+            template <class T>
+            static constexpr T neutral() {
+                return T(0);
+            }
+
             template <class T>
             GT_FUNCTION auto operator()(T const &x, T const &y) const {
                 return x | y;
             }
         };
         struct bitwise_xor {
+            template <class T>
+            static constexpr T neutral() {
+                return T(0);
+            }
+
             template <class T>
             GT_FUNCTION auto operator()(T const &x, T const &y) const {
                 return x ^ y;
             }
         };
+
+        /**
+         *   Reduction with `F` of the elements transformed by `Map`.
+         *
+         *   The transformation is applied to the elements only, hence it is supported by the fused reductions, that
+         *   keep the elements and the partial results apart, but not by `reducible::reduce(F)`.
+         */
+        template <class F, class Map>
+        struct transformed {};
+
+        struct square {
+            template <class T>
+            GT_FUNCTION T operator()(T const &x) const {
+                return x * x;
+            }
+        };
+
+        using sum_of_squares = transformed<plus, square>;
     } // namespace reduction
 } // namespace gridtools
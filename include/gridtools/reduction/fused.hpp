@@ -0,0 +1,225 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+
+#include "../common/defs.hpp"
+#include "../common/host_device.hpp"
+#include "../common/integral_constant.hpp"
+#include "../common/tuple.hpp"
+#include "../common/tuple_util.hpp"
+#include "../meta.hpp"
+#include "functions.hpp"
+
+/**
+ *   Fused reductions: several reduction functors are evaluated on several buffers of the same shape in a single pass.
+ *
+ *   The buffers are traversed as rows along the dimension with the smallest stride of the first buffer, the elements
+ *   outside of the shape (padding) are never touched. Every functor accumulates into its own lanes, hence the inner
+ *   loops vectorize. The functors need a `neutral<T>()` static member, which the functors in `functions.hpp` provide,
+ *   and `transformed<F, Map>` applies `Map` to the elements before reducing them with `F`.
+ *
+ *   The backends parallelize the rows by providing
+ *     `Acc reduction_reduce_rows(Backend, size_t num_rows, Acc init, RowFun row_fun, Merge merge)`,
+ *   where `row_fun(acc, row)` accumulates the row into `acc` and `merge(lhs, rhs)` combines two accumulators.
+ */
+namespace gridtools {
+    namespace reduction {
+        namespace fused_impl_ {
+            constexpr size_t lanes = 8;
+
+            template <class F>
+            struct fun_traits {
+                using combine_t = F;
+
+                template <class T>
+                static GT_FORCE_INLINE T map(T const &x) {
+                    return x;
+                }
+            };
+
+            template <class F, class Map>
+            struct fun_traits<transformed<F, Map>> {
+                using combine_t = F;
+
+                template <class T>
+                static GT_FORCE_INLINE T map(T const &x) {
+                    return Map()(x);
+                }
+            };
+
+            template <class T, class Funs>
+            auto neutral_values(Funs const &funs) {
+                return tuple_util::transform(
+                    [](auto fun) { return fun_traits<decltype(fun)>::combine_t::template neutral<T>(); }, funs);
+            }
+
+            template <class Funs, class Values>
+            Values merge_values(Values const &lhs, Values const &rhs) {
+                return tuple_util::transform(
+                    [](auto fun, auto const &x, auto const &y) {
+                        return typename fun_traits<decltype(fun)>::combine_t()(x, y);
+                    },
+                    Funs(),
+                    lhs,
+                    rhs);
+            }
+
+            template <class Funs, class Values, class T, class Stride>
+            GT_FORCE_INLINE void reduce_row(Values &values, T const *ptr, Stride stride, int_t size) {
+                auto lane_values = tuple_util::transform(
+                    [](T neutral) {
+                        std::array<T, lanes> res;
+                        res.fill(neutral);
+                        return res;
+                    },
+                    neutral_values<T>(Funs()));
+                int_t i = 0;
+                for (; i + int_t(lanes) <= size; i += lanes) {
+                    T x[lanes];
+                    for (size_t l = 0; l != lanes; ++l)
+                        x[l] = ptr[(i + l) * stride];
+                    tuple_util::for_each(
+                        [&x](auto fun, auto &acc) {
+                            using traits_t = fun_traits<decltype(fun)>;
+                            typename traits_t::combine_t combine;
+#pragma omp simd
+                            for (size_t l = 0; l < lanes; ++l)
+                                acc[l] = combine(acc[l], traits_t::map(x[l]));
+                        },
+                        Funs(),
+                        lane_values);
+                }
+                for (; i < size; ++i)
+                    tuple_util::for_each(
+                        [x = ptr[i * stride]](auto fun, auto &acc) {
+                            using traits_t = fun_traits<decltype(fun)>;
+                            acc[0] = typename traits_t::combine_t()(acc[0], traits_t::map(x));
+                        },
+                        Funs(),
+                        lane_values);
+                tuple_util::for_each(
+                    [](auto fun, auto &value, auto const &acc) {
+                        typename fun_traits<decltype(fun)>::combine_t combine;
+                        for (size_t l = 0; l != lanes; ++l)
+                            value = combine(value, acc[l]);
+                    },
+                    Funs(),
+                    values,
+                    lane_values);
+            }
+
+            template <class T, size_t N>
+            struct input {
+                T const *m_ptr;
+                std::array<int_t, N> m_strides;
+            };
+
+            template <size_t N>
+            struct row_plan {
+                std::array<int_t, N> m_sizes;
+                size_t m_inner;
+
+                size_t num_rows() const {
+                    size_t res = 1;
+                    for (size_t d = 0; d != N; ++d)
+                        if (d != m_inner)
+                            res *= m_sizes[d];
+                    return res;
+                }
+
+                template <class T>
+                T const *row_origin(input<T, N> const &src, size_t row) const {
+                    T const *res = src.m_ptr;
+                    for (size_t d = 0; d != N; ++d) {
+                        if (d == m_inner)
+                            continue;
+                        res += int_t(row % m_sizes[d]) * src.m_strides[d];
+                        row /= m_sizes[d];
+                    }
+                    return res;
+                }
+
+                // the indices of the first element of the row, the inner index is zero
+                std::array<int_t, N> row_index(size_t row) const {
+                    std::array<int_t, N> res = {};
+                    for (size_t d = 0; d != N; ++d) {
+                        if (d == m_inner)
+                            continue;
+                        res[d] = int_t(row % m_sizes[d]);
+                        row /= m_sizes[d];
+                    }
+                    return res;
+                }
+
+                template <class Funs, class Values, class T>
+                void reduce(Values &values, input<T, N> const &src, size_t row) const {
+                    T const *ptr = row_origin(src, row);
+                    int_t stride = src.m_strides[m_inner];
+                    if (stride == 1)
+                        reduce_row<Funs>(values, ptr, integral_constant<int_t, 1>(), m_sizes[m_inner]);
+                    else
+                        reduce_row<Funs>(values, ptr, stride, m_sizes[m_inner]);
+                }
+            };
+
+            template <size_t N>
+            row_plan<N> make_row_plan(std::array<int_t, N> const &sizes, std::array<int_t, N> const &strides) {
+                size_t inner = 0;
+                for (size_t d = 1; d != N; ++d)
+                    if (std::abs(strides[d]) < std::abs(strides[inner]))
+                        inner = d;
+                return {sizes, inner};
+            }
+
+            template <class Ptr, class Strides>
+            auto make_input(Ptr ptr, Strides const &strides) {
+                using element_t = std::remove_cv_t<std::remove_pointer_t<Ptr>>;
+                return input<element_t, tuple_util::size<Strides>::value>{
+                    ptr, tuple_util::convert_to<std::array, int_t>(strides)};
+            }
+
+            /**
+             *   Reduces all the inputs with all the functors `Funs` in a single pass and returns the results as a tuple
+             *   (per input) of tuples (per functor).
+             */
+            template <class Backend, class Funs, size_t N, class T, class... Ts>
+            auto reduce(Backend,
+                Funs,
+                std::array<int_t, N> const &sizes,
+                input<T, N> const &first,
+                input<Ts, N> const &...rest) {
+                static_assert(
+                    meta::all_of<std::is_empty, Funs>::value, "Fused reductions support only stateless functors.");
+                using acc_t = tuple<decltype(neutral_values<T>(Funs())), decltype(neutral_values<Ts>(Funs()))...>;
+                auto plan = make_row_plan(sizes, first.m_strides);
+                return reduction_reduce_rows(
+                    Backend(),
+                    plan.num_rows(),
+                    acc_t{neutral_values<T>(Funs()), neutral_values<Ts>(Funs())...},
+                    [&plan, inputs = tuple<input<T, N>, input<Ts, N>...>(first, rest...)](acc_t &acc, size_t row) {
+                        tuple_util::for_each(
+                            [&](auto &values, auto const &src) { plan.template reduce<Funs>(values, src, row); },
+                            acc,
+                            inputs);
+                    },
+                    [](acc_t const &lhs, acc_t const &rhs) {
+                        return tuple_util::transform(
+                            [](auto const &x, auto const &y) { return merge_values<Funs>(x, y); }, lhs, rhs);
+                    });
+            }
+        } // namespace fused_impl_
+    }     // namespace reduction
+} // namespace gridtools
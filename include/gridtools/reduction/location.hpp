@@ -0,0 +1,236 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "../common/defs.hpp"
+#include "../common/integral_constant.hpp"
+#include "fused.hpp"
+#include "functions.hpp"
+
+/**
+ *   Location reductions: the indices of the extreme elements of a buffer.
+ *
+ *   The buffer is traversed in rows along the dimension with the smallest stride, like in the fused reductions, and
+ *   the rows are distributed by `reduction_reduce_rows` of the backend. Within a row every lane keeps its own
+ *   candidate, hence the inner loop vectorizes. The ties are broken by the smallest index in lexicographic order,
+ *   the result depends neither on the storage layout nor on the number of threads. NaNs are never selected.
+ */
+namespace gridtools {
+    namespace reduction {
+        namespace location_impl_ {
+            template <class F>
+            struct order;
+
+            template <>
+            struct order<min> {
+                template <class T>
+                static GT_FORCE_INLINE bool better(T const &x, T const &y) {
+                    return x < y;
+                }
+            };
+
+            template <>
+            struct order<max> {
+                template <class T>
+                static GT_FORCE_INLINE bool better(T const &x, T const &y) {
+                    return x > y;
+                }
+            };
+
+            /**
+             *   An element of a buffer and its indices. The indices are negative if no element was selected, which
+             *   happens only if the buffer is empty or contains NaNs only.
+             */
+            template <class T, size_t N>
+            struct location {
+                T value;
+                std::array<int_t, N> index;
+
+                bool valid() const { return index[0] >= 0; }
+            };
+
+            template <class F, class T, size_t N>
+            bool better(location<T, N> const &lhs, location<T, N> const &rhs) {
+                if (!rhs.valid())
+                    return lhs.valid();
+                if (!lhs.valid())
+                    return false;
+                return order<F>::better(lhs.value, rhs.value) || (lhs.value == rhs.value && lhs.index < rhs.index);
+            }
+
+            template <class F, class T, size_t N>
+            location<T, N> invalid_location() {
+                location<T, N> res = {F::template neutral<T>(), {}};
+                res.index.fill(-1);
+                return res;
+            }
+
+            // the position of the best element of the row, or -1
+            template <class F, class T, class Stride>
+            GT_FORCE_INLINE int_t select_in_row(T &value, T const *ptr, Stride stride, int_t size) {
+                constexpr int_t lanes = fused_impl_::lanes;
+                T best[lanes];
+                int_t pos[lanes];
+                for (int_t l = 0; l != lanes; ++l) {
+                    best[l] = F::template neutral<T>();
+                    pos[l] = -1;
+                }
+                int_t i = 0;
+                for (; i + lanes <= size; i += lanes) {
+#pragma omp simd
+                    for (int_t l = 0; l < lanes; ++l) {
+                        T x = ptr[(i + l) * stride];
+                        bool take = order<F>::better(x, best[l]) || (x == best[l] && pos[l] < 0);
+                        best[l] = take ? x : best[l];
+                        pos[l] = take ? i + l : pos[l];
+                    }
+                }
+                for (; i < size; ++i) {
+                    T x = ptr[i * stride];
+                    if (order<F>::better(x, best[0]) || (x == best[0] && pos[0] < 0)) {
+                        best[0] = x;
+                        pos[0] = i;
+                    }
+                }
+                int_t res = -1;
+                for (int_t l = 0; l != lanes; ++l) {
+                    if (pos[l] < 0)
+                        continue;
+                    if (res < 0 || order<F>::better(best[l], value) || (best[l] == value && pos[l] < res)) {
+                        value = best[l];
+                        res = pos[l];
+                    }
+                }
+                return res;
+            }
+
+            /**
+             *   The best element of `src` with respect to `F` (`min` or `max`).
+             */
+            template <class F, class Backend, class T, size_t N>
+            location<T, N> arg_reduce(Backend, std::array<int_t, N> const &sizes, fused_impl_::input<T, N> const &src) {
+                auto plan = fused_impl_::make_row_plan(sizes, src.m_strides);
+                int_t stride = src.m_strides[plan.m_inner];
+                return reduction_reduce_rows(
+                    Backend(),
+                    plan.num_rows(),
+                    invalid_location<F, T, N>(),
+                    [&](location<T, N> &acc, size_t row) {
+                        T const *ptr = plan.row_origin(src, row);
+                        int_t size = sizes[plan.m_inner];
+                        T value = F::template neutral<T>();
+                        int_t pos = stride == 1
+                                        ? select_in_row<F>(value, ptr, integral_constant<int_t, 1>(), size)
+                                        : select_in_row<F>(value, ptr, stride, size);
+                        if (pos < 0)
+                            return;
+                        location<T, N> cur = {value, plan.row_index(row)};
+                        cur.index[plan.m_inner] = pos;
+                        if (better<F>(cur, acc))
+                            acc = cur;
+                    },
+                    [](location<T, N> const &lhs, location<T, N> const &rhs) {
+                        return better<F>(rhs, lhs) ? rhs : lhs;
+                    });
+            }
+
+            // the `k` best locations seen so far, best first
+            template <class F, class T, size_t N>
+            struct top_list {
+                size_t m_k;
+                std::vector<location<T, N>> m_items;
+
+                bool full() const { return m_items.size() == m_k; }
+
+                void insert(location<T, N> const &item) {
+                    if (full() && !better<F>(item, m_items.back()))
+                        return;
+                    m_items.insert(std::upper_bound(m_items.begin(), m_items.end(), item, better<F, T, N>), item);
+                    if (m_items.size() > m_k)
+                        m_items.pop_back();
+                }
+            };
+
+            template <class F, class T, size_t N, class Stride>
+            GT_FORCE_INLINE void select_top_in_row(top_list<F, T, N> &acc,
+                T const *ptr,
+                Stride stride,
+                int_t size,
+                std::array<int_t, N> index,
+                size_t inner) {
+                constexpr int_t lanes = fused_impl_::lanes;
+                auto try_insert = [&](int_t i) {
+                    T x = ptr[i * stride];
+                    if (x != x)
+                        return;
+                    index[inner] = i;
+                    acc.insert({x, index});
+                };
+                int_t i = 0;
+                for (; i + lanes <= size; i += lanes) {
+                    if (acc.full()) {
+                        T threshold = acc.m_items.back().value;
+                        bool any = false;
+#pragma omp simd reduction(|| : any)
+                        for (int_t l = 0; l < lanes; ++l) {
+                            T x = ptr[(i + l) * stride];
+                            any = any || (x == x && !order<F>::better(threshold, x));
+                        }
+                        if (!any)
+                            continue;
+                    }
+                    for (int_t l = 0; l != lanes; ++l)
+                        try_insert(i + l);
+                }
+                for (; i < size; ++i)
+                    try_insert(i);
+            }
+
+            /**
+             *   The `k` best elements of `src` with respect to `F` (`min` or `max`), best first. There are less than
+             *   `k` of them only if `src` has less than `k` elements that are not NaN.
+             */
+            template <class F, class Backend, class T, size_t N>
+            std::vector<location<T, N>> top_k(
+                Backend, size_t k, std::array<int_t, N> const &sizes, fused_impl_::input<T, N> const &src) {
+                using acc_t = top_list<F, T, N>;
+                if (k == 0)
+                    return {};
+                auto plan = fused_impl_::make_row_plan(sizes, src.m_strides);
+                int_t stride = src.m_strides[plan.m_inner];
+                return reduction_reduce_rows(
+                    Backend(),
+                    plan.num_rows(),
+                    acc_t{k, {}},
+                    [&](acc_t &acc, size_t row) {
+                        T const *ptr = plan.row_origin(src, row);
+                        int_t size = sizes[plan.m_inner];
+                        auto index = plan.row_index(row);
+                        if (stride == 1)
+                            select_top_in_row(
+                                acc, ptr, integral_constant<int_t, 1>(), size, index, plan.m_inner);
+                        else
+                            select_top_in_row(acc, ptr, stride, size, index, plan.m_inner);
+                    },
+                    [](acc_t lhs, acc_t const &rhs) {
+                        for (auto const &item : rhs.m_items)
+                            lhs.insert(item);
+                        return lhs;
+                    })
+                    .m_items;
+            }
+        } // namespace location_impl_
+        using location_impl_::location;
+    } // namespace reduction
+} // namespace gridtools
@@ -22,6 +22,19 @@ namespace gridtools {
             return res;
         }
 
+        template <class Acc, class RowFun, class Merge>
+        Acc reduction_reduce_rows(naive, size_t num_rows, Acc res, RowFun const &row_fun, Merge) {
+            for (size_t row = 0; row != num_rows; ++row)
+                row_fun(res, row);
+            return res;
+        }
+
+        template <class F>
+        void reduction_parallel_for(naive, size_t size, F const &f) {
+            for (size_t i = 0; i != size; ++i)
+                f(i);
+        }
+
         inline size_t reduction_round_size(naive, size_t size) { return size; }
         inline size_t reduction_allocation_size(naive, size_t size) { return size; }
 
@@ -0,0 +1,140 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <array>
+#include <cstdlib>
+
+#include "../common/defs.hpp"
+#include "../common/integral_constant.hpp"
+#include "../common/tuple.hpp"
+#include "../common/tuple_util.hpp"
+#include "fused.hpp"
+
+/**
+ *   Partial reductions: a subset of the dimensions of a buffer is reduced, the result has the remaining dimensions.
+ *
+ *   The iteration follows the strides of the input. If the dimension with the smallest stride is reduced, every
+ *   result element is computed by reducing rows along that dimension with the vectorized kernel of the fused
+ *   reductions. Otherwise the rows of the result are accumulated element-wise, which vectorizes along the kept
+ *   dimension. In both cases the backend parallelizes over the result elements (or rows) by providing
+ *     `void reduction_parallel_for(Backend, size_t size, F f)`,
+ *   that calls `f(index)` for every index in [0, size). Every result element is reduced in a fixed order.
+ */
+namespace gridtools {
+    namespace reduction {
+        namespace partial_impl_ {
+            template <size_t N>
+            struct dim_set {
+                std::array<size_t, N> m_dims = {};
+                size_t m_size = 0;
+
+                void add(size_t dim) { m_dims[m_size++] = dim; }
+
+                size_t volume(std::array<int_t, N> const &sizes) const {
+                    size_t res = 1;
+                    for (size_t d = 0; d != m_size; ++d)
+                        res *= sizes[m_dims[d]];
+                    return res;
+                }
+
+                // the offset of the linear index `index` of the subspace spanned by the set
+                int_t offset(
+                    size_t index, std::array<int_t, N> const &sizes, std::array<int_t, N> const &strides) const {
+                    int_t res = 0;
+                    for (size_t d = 0; d != m_size; ++d) {
+                        size_t dim = m_dims[d];
+                        res += int_t(index % sizes[dim]) * strides[dim];
+                        index /= sizes[dim];
+                    }
+                    return res;
+                }
+            };
+
+            template <class F, class T, class Stride, class OutStride>
+            GT_FORCE_INLINE void accumulate_row(T *out, OutStride out_stride, T const *in, Stride stride, int_t size) {
+                using traits_t = fused_impl_::fun_traits<F>;
+                typename traits_t::combine_t combine;
+#pragma omp simd
+                for (int_t i = 0; i < size; ++i)
+                    out[i * out_stride] = combine(out[i * out_stride], traits_t::map(in[i * stride]));
+            }
+
+            /**
+             *   Reduces the dimensions of `in` that are marked in `reduced` with `F`. `out_strides` are the strides of
+             *   the output per dimension of the input, they are ignored for the reduced dimensions.
+             */
+            template <class Backend, class F, class T, size_t N>
+            void reduce(Backend,
+                F,
+                std::array<bool, N> const &reduced,
+                std::array<int_t, N> const &sizes,
+                T const *in,
+                std::array<int_t, N> const &in_strides,
+                T *out,
+                std::array<int_t, N> const &out_strides) {
+                using funs_t = tuple<F>;
+                T neutral = fused_impl_::fun_traits<F>::combine_t::template neutral<T>();
+                size_t inner = 0;
+                for (size_t d = 1; d != N; ++d)
+                    if (std::abs(in_strides[d]) < std::abs(in_strides[inner]))
+                        inner = d;
+                dim_set<N> kept, reduced_dims, kept_outer;
+                for (size_t d = 0; d != N; ++d) {
+                    (reduced[d] ? reduced_dims : kept).add(d);
+                    if (!reduced[d] && d != inner)
+                        kept_outer.add(d);
+                }
+                int_t inner_size = sizes[inner];
+                int_t in_stride = in_strides[inner];
+                if (reduced[inner]) {
+                    dim_set<N> outer;
+                    for (size_t d = 0; d != reduced_dims.m_size; ++d)
+                        if (reduced_dims.m_dims[d] != inner)
+                            outer.add(reduced_dims.m_dims[d]);
+                    size_t outer_volume = outer.volume(sizes);
+                    reduction_parallel_for(Backend(), kept.volume(sizes), [&](size_t index) {
+                        T const *ptr = in + kept.offset(index, sizes, in_strides);
+                        tuple<T> values = {neutral};
+                        for (size_t row = 0; row != outer_volume; ++row) {
+                            T const *row_ptr = ptr + outer.offset(row, sizes, in_strides);
+                            if (in_stride == 1)
+                                fused_impl_::reduce_row<funs_t>(
+                                    values, row_ptr, integral_constant<int_t, 1>(), inner_size);
+                            else
+                                fused_impl_::reduce_row<funs_t>(values, row_ptr, in_stride, inner_size);
+                        }
+                        out[kept.offset(index, sizes, out_strides)] = tuple_util::get<0>(values);
+                    });
+                    return;
+                }
+                int_t out_stride = out_strides[inner];
+                size_t reduced_volume = reduced_dims.volume(sizes);
+                reduction_parallel_for(Backend(), kept_outer.volume(sizes), [&](size_t index) {
+                    T const *ptr = in + kept_outer.offset(index, sizes, in_strides);
+                    T *out_ptr = out + kept_outer.offset(index, sizes, out_strides);
+                    for (int_t i = 0; i < inner_size; ++i)
+                        out_ptr[i * out_stride] = neutral;
+                    for (size_t row = 0; row != reduced_volume; ++row) {
+                        T const *row_ptr = ptr + reduced_dims.offset(row, sizes, in_strides);
+                        if (in_stride == 1 && out_stride == 1)
+                            accumulate_row<F>(out_ptr,
+                                integral_constant<int_t, 1>(),
+                                row_ptr,
+                                integral_constant<int_t, 1>(),
+                                inner_size);
+                        else
+                            accumulate_row<F>(out_ptr, out_stride, row_ptr, in_stride, inner_size);
+                    }
+                });
+            }
+        } // namespace partial_impl_
+    }     // namespace reduction
+} // namespace gridtools
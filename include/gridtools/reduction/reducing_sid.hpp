@@ -0,0 +1,347 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../common/array.hpp"
+#include "../common/defs.hpp"
+#include "../common/integral_constant.hpp"
+#include "../common/tuple.hpp"
+#include "../common/tuple_util.hpp"
+#include "../sid/concept.hpp"
+#include "../sid/unknown_kind.hpp"
+#include "fused.hpp"
+#include "functions.hpp"
+
+/**
+ *   Reduce on write: SIDs that reduce the values written to them by a stencil.
+ *
+ *   `make_reducing_sid(f, r)` wraps the `reducible` `r`: the values are stored to `r` and reduced with `f` at the same
+ *   time, hence there is no need to read the buffer again afterwards. `make_reducing_sink<T>(f, sizes...)` has no
+ *   buffer at all, the values are only reduced. The partial results are accumulated per thread (the slot of the thread
+ *   is looked up once per block by the backend) and per lane, `result()` combines them after the stencil run. The lane
+ *   of a point is its index along the first dimension, the dimension of the vectorized inner loops of the backends,
+ *   modulo the number of lanes. Hence the iterations of such a loop never accumulate into the same value. `f` can be
+ *   any functor from `functions.hpp`, including `transformed` ones like `sum_of_squares`.
+ *
+ *   The SIDs are write only: the stencil must assign every point exactly once. Reading the field does not compile.
+ *   Writing it from a stage that is computed on an extended domain is detected at run time: the points outside of the
+ *   SID are not reduced, and `result()` throws if such points were written or if the number of writes is not a
+ *   multiple of the number of points.
+ *
+ *   Usage:
+ *     auto sum = reduction::make_reducing_sink<double>(reduction::plus(), 23, 19, 7);
+ *     run_single_stage(functor(), stencil::cpu_ifirst<>(), grid, sum, in);
+ *     double res = sum.result();
+ */
+namespace gridtools {
+    namespace reduction {
+        namespace reducing_sid_impl_ {
+            // the maximum number of threads that write to a reducing sid simultaneously
+            constexpr int max_threads = 512;
+
+            constexpr std::ptrdiff_t lanes = fused_impl_::lanes;
+            static_assert((lanes & (lanes - 1)) == 0, "the number of lanes must be a power of two");
+
+            // dense indices of the running threads, the indices of the finished threads are reused
+            class thread_index {
+                int m_value;
+
+                static std::mutex &mutex() {
+                    static std::mutex res;
+                    return res;
+                }
+
+                static std::vector<int> &free_indices() {
+                    static std::vector<int> res;
+                    return res;
+                }
+
+                static int acquire() {
+                    static int next = 0;
+                    std::lock_guard<std::mutex> lock(mutex());
+                    auto &indices = free_indices();
+                    if (indices.empty())
+                        return next++;
+                    int res = indices.back();
+                    indices.pop_back();
+                    return res;
+                }
+
+              public:
+                thread_index() : m_value(acquire()) {}
+                thread_index(thread_index const &) = delete;
+                thread_index &operator=(thread_index const &) = delete;
+
+                ~thread_index() {
+                    std::lock_guard<std::mutex> lock(mutex());
+                    free_indices().push_back(m_value);
+                }
+
+                static int get() {
+                    static thread_local thread_index res;
+                    return res.m_value;
+                }
+            };
+
+            /*
+             *  The accumulator of a lane, it is the reference type of the SIDs: a dereferenced pointer points the lane
+             *  of the element to the element, the assignment reduces the value and stores it to the element. The
+             *  conversion to a value is there only to reject the reads at compile time.
+             */
+            template <class F, class T, bool Store>
+            struct lane {
+                using traits_t = fused_impl_::fun_traits<F>;
+
+                T m_value;
+                std::size_t m_writes;
+                std::size_t m_misses;
+                T *m_target;
+                bool m_inside;
+
+                lane &operator=(T const &value) {
+                    ++m_writes;
+                    if (!m_inside) {
+                        ++m_misses;
+                        return *this;
+                    }
+                    m_value = typename traits_t::combine_t()(m_value, traits_t::map(value));
+                    if constexpr (Store)
+                        *m_target = value;
+                    return *this;
+                }
+
+                lane &operator=(lane const &) = delete;
+
+                template <class U>
+                operator U() const {
+                    static_assert(sizeof(U) < 0, "reducing sids are write only");
+                    return {};
+                }
+            };
+
+            // the per thread accumulator
+            template <class F, class T, bool Store>
+            struct alignas(64) writer {
+                using traits_t = fused_impl_::fun_traits<F>;
+
+                lane<F, T, Store> m_lanes[lanes];
+                bool m_used;
+            };
+
+            // the positions of the points of a SID relative to its origin
+            struct layout {
+                std::ptrdiff_t m_stride; // the stride of the first dimension
+                std::ptrdiff_t m_span;   // the positions of the points are in `[0, m_span)`
+                std::size_t m_points;
+            };
+
+            template <class F, class T, bool Store>
+            class state {
+                using writer_t = writer<F, T, Store>;
+
+                std::unique_ptr<writer_t[]> m_writers;
+                layout m_layout;
+
+              public:
+                state(layout const &layout) : m_writers(new writer_t[max_threads]), m_layout(layout) { reset(); }
+
+                layout const &get_layout() const { return m_layout; }
+
+                writer_t &local() {
+                    int index = thread_index::get();
+                    if (index >= max_threads)
+                        throw std::runtime_error("too many threads write to a reducing sid");
+                    auto &res = m_writers[index];
+                    res.m_used = true;
+                    return res;
+                }
+
+                void reset() {
+                    for (int i = 0; i != max_threads; ++i) {
+                        for (auto &lane : m_writers[i].m_lanes) {
+                            lane.m_value = writer_t::traits_t::combine_t::template neutral<T>();
+                            lane.m_writes = 0;
+                            lane.m_misses = 0;
+                            lane.m_target = nullptr;
+                        }
+                        m_writers[i].m_used = false;
+                    }
+                }
+
+                T result() const {
+                    typename writer_t::traits_t::combine_t combine;
+                    T res = writer_t::traits_t::combine_t::template neutral<T>();
+                    std::size_t writes = 0;
+                    std::size_t misses = 0;
+                    for (int i = 0; i != max_threads; ++i) {
+                        if (!m_writers[i].m_used)
+                            continue;
+                        for (auto const &lane : m_writers[i].m_lanes) {
+                            res = combine(res, lane.m_value);
+                            writes += lane.m_writes;
+                            misses += lane.m_misses;
+                        }
+                    }
+                    if (misses || (m_layout.m_points && writes % m_layout.m_points))
+                        throw std::runtime_error("a reducing sid was written outside of the computation area");
+                    return res;
+                }
+            };
+
+            template <class F, class T, bool Store>
+            struct ptr {
+                writer<F, T, Store> *m_writer;
+                layout const *m_layout;
+                T *m_target;
+                std::ptrdiff_t m_pos;
+
+                lane<F, T, Store> &operator*() const {
+                    std::ptrdiff_t stride = m_layout->m_stride;
+                    std::ptrdiff_t index = stride == 1 ? m_pos : m_pos / stride;
+                    auto &res = m_writer->m_lanes[index & (lanes - 1)];
+                    res.m_target = m_target;
+                    res.m_inside = m_pos >= 0 && m_pos < m_layout->m_span;
+                    return res;
+                }
+
+                ptr &operator+=(std::ptrdiff_t diff) {
+                    if constexpr (Store)
+                        m_target += diff;
+                    m_pos += diff;
+                    return *this;
+                }
+
+                friend ptr operator+(ptr obj, std::ptrdiff_t diff) { return obj += diff; }
+            };
+
+            template <class F, class T, bool Store>
+            struct ptr_holder {
+                state<F, T, Store> *m_state;
+                T *m_origin;
+                std::ptrdiff_t m_pos;
+
+                // called by the backends once per block, on the thread that processes the block
+                ptr<F, T, Store> operator()() const {
+                    return {&m_state->local(), &m_state->get_layout(), m_origin + m_pos, m_pos};
+                }
+
+                friend ptr_holder operator+(ptr_holder obj, std::ptrdiff_t diff) {
+                    obj.m_pos += diff;
+                    return obj;
+                }
+            };
+
+            template <class Sizes>
+            std::size_t num_points(Sizes const &sizes) {
+                return tuple_util::fold([](std::size_t acc, auto size) { return acc * size; }, std::size_t(1), sizes);
+            }
+
+            template <class F, class T, class Reducible>
+            class reducing_sid {
+                using state_t = state<F, T, true>;
+
+                std::shared_ptr<state_t> m_state;
+                Reducible m_reducible;
+
+              public:
+                reducing_sid(Reducible reducible)
+                    : m_state(std::make_shared<state_t>(
+                          layout{sid::get_stride<integral_constant<int, 0>>(sid::get_strides(reducible)),
+                              std::ptrdiff_t(reducible.m_size),
+                              num_points(reducible.m_sizes)})),
+                      m_reducible(std::move(reducible)) {}
+
+                T result() const { return m_state->result(); }
+                void reset() { m_state->reset(); }
+                Reducible const &buffer() const { return m_reducible; }
+
+                friend ptr_holder<F, T, true> sid_get_origin(reducing_sid const &obj) {
+                    return {obj.m_state.get(), obj.m_reducible.m_origin(), 0};
+                }
+                friend auto sid_get_strides(reducing_sid const &obj) { return sid_get_strides(obj.m_reducible); }
+                friend auto sid_get_lower_bounds(reducing_sid const &obj) {
+                    return sid_get_lower_bounds(obj.m_reducible);
+                }
+                friend auto sid_get_upper_bounds(reducing_sid const &obj) {
+                    return sid_get_upper_bounds(obj.m_reducible);
+                }
+            };
+
+            template <class F, class T, class Reducible>
+            std::ptrdiff_t sid_get_ptr_diff(reducing_sid<F, T, Reducible> const &);
+
+            template <class F, class T, class Reducible>
+            decltype(sid_get_strides_kind(std::declval<Reducible const &>())) sid_get_strides_kind(
+                reducing_sid<F, T, Reducible> const &);
+
+            // the sink has the strides of a dense buffer, the positions of its points are unique
+            template <class F, class T, class Sizes>
+            class reducing_sink {
+                using state_t = state<F, T, false>;
+                using strides_t = array<std::ptrdiff_t, tuple_util::size<Sizes>::value>;
+
+                std::shared_ptr<state_t> m_state;
+                Sizes m_sizes;
+                strides_t m_strides;
+
+              public:
+                reducing_sink(Sizes sizes) : m_sizes(std::move(sizes)) {
+                    std::ptrdiff_t stride = 1;
+                    tuple_util::for_each(
+                        [&](auto size, std::ptrdiff_t &dst) {
+                            dst = stride;
+                            stride *= size;
+                        },
+                        m_sizes,
+                        m_strides);
+                    m_state = std::make_shared<state_t>(layout{1, stride, std::size_t(stride)});
+                }
+
+                T result() const { return m_state->result(); }
+                void reset() { m_state->reset(); }
+
+                friend ptr_holder<F, T, false> sid_get_origin(reducing_sink const &obj) {
+                    return {obj.m_state.get(), nullptr, 0};
+                }
+                friend strides_t sid_get_strides(reducing_sink const &obj) { return obj.m_strides; }
+                friend auto sid_get_lower_bounds(reducing_sink const &obj) {
+                    return tuple_util::transform([](auto) { return integral_constant<int_t, 0>(); }, obj.m_sizes);
+                }
+                friend Sizes sid_get_upper_bounds(reducing_sink const &obj) { return obj.m_sizes; }
+            };
+
+            template <class F, class T, class Sizes>
+            std::ptrdiff_t sid_get_ptr_diff(reducing_sink<F, T, Sizes> const &);
+
+            template <class F, class T, class Sizes>
+            sid::unknown_kind sid_get_strides_kind(reducing_sink<F, T, Sizes> const &);
+
+            template <class F, class Reducible>
+            auto make_reducing_sid(F, Reducible reducible) {
+                return reducing_sid<F, std::decay_t<decltype(reducible.neutral_value)>, Reducible>(
+                    std::move(reducible));
+            }
+
+            template <class T, class F, class... Dims>
+            reducing_sink<F, T, tuple<Dims...>> make_reducing_sink(F, Dims... dims) {
+                return {tuple<Dims...>(dims...)};
+            }
+        } // namespace reducing_sid_impl_
+        using reducing_sid_impl_::make_reducing_sid;
+        using reducing_sid_impl_::make_reducing_sink;
+    } // namespace reduction
+} // namespace gridtools
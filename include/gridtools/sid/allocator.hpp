@@ -12,9 +12,11 @@
 #ifndef GT_SID_ALLOCATOR_HPP_
 #define GT_SID_ALLOCATOR_HPP_
 
+#include <atomic>
+#include <deque>
+#include <list>
 #include <map>
 #include <memory>
-#include <stack>
 #include <utility>
 #include <vector>
 
@@ -50,7 +52,10 @@
  *  Semantics:
  *    - `allocator` keeps the resources that are allocated and releases them in dtor.
  *    - `cached_allocator` keeps resources during its lifetime. On dtor it stashes the resources in the internal static
- *      storage. The newly created instances of `cached_allocator` will attempt to reuse the stashed resources.
+ *      (per thread) storage. The newly created instances of `cached_allocator` will attempt to reuse the stashed
+ *      resources. The sizes are rounded up to size classes, so that slightly different sizes share the resources.
+ *      The stashed bytes per thread are bounded by `set_cached_allocator_limit` (1GB by default), the least recently
+ *      stashed resources are released first. `cached_allocator_statistics` returns the hit/miss/resident counters.
  *
  *  To make the simplest possible allocator one can do:
  *    `auto alloc = allocator(&std::make_unique<char[]>);`
@@ -61,40 +66,135 @@ namespace gridtools {
     namespace sid {
         namespace allocator_impl_ {
 
+            // Sizes are rounded up to 64 bytes, larger sizes to one of four classes per power of two
+            inline size_t size_class(size_t size) {
+                size = (size + 63) / 64 * 64;
+                if (size <= 256)
+                    return size;
+                size_t step = 1;
+                while (step <= size / 8)
+                    step *= 2;
+                return (size + step - 1) / step * step;
+            }
+
+            struct cache_statistics {
+                size_t hits;           // allocations served from the cache
+                size_t misses;         // allocations that needed fresh resources
+                size_t evictions;      // stashed resources that were released to stay within the limit
+                size_t resident_bytes; // stashed bytes over all threads
+            };
+
+            struct cache_counters {
+                std::atomic<size_t> hits{0};
+                std::atomic<size_t> misses{0};
+                std::atomic<size_t> evictions{0};
+                std::atomic<size_t> resident_bytes{0};
+                std::atomic<size_t> limit{size_t(1) << 30};
+            };
+
+            inline cache_counters &counters() {
+                static cache_counters res;
+                return res;
+            }
+
+            // The stashed resources of one thread, in the LRU order
+            template <class Ptr>
+            class cache {
+                using lru_t = std::list<std::pair<size_t, Ptr>>;
+
+                lru_t m_lru; // the most recently stashed first
+                std::map<size_t, std::deque<typename lru_t::iterator>> m_classes;
+                size_t m_resident_bytes = 0;
+
+              public:
+                cache() = default;
+                cache(cache const &) = delete;
+                cache &operator=(cache const &) = delete;
+                ~cache() { counters().resident_bytes -= m_resident_bytes; }
+
+                bool pop(size_t size, Ptr &res) {
+                    auto found = m_classes.find(size);
+                    if (found == m_classes.end()) {
+                        ++counters().misses;
+                        return false;
+                    }
+                    auto &entries = found->second;
+                    res = std::move(entries.back()->second);
+                    m_lru.erase(entries.back());
+                    entries.pop_back();
+                    if (entries.empty())
+                        m_classes.erase(found);
+                    m_resident_bytes -= size;
+                    counters().resident_bytes -= size;
+                    ++counters().hits;
+                    return true;
+                }
+
+                void push(size_t size, Ptr ptr) {
+                    m_lru.emplace_front(size, std::move(ptr));
+                    m_classes[size].push_back(m_lru.begin());
+                    m_resident_bytes += size;
+                    counters().resident_bytes += size;
+                    trim(counters().limit);
+                }
+
+                void trim(size_t limit) {
+                    while (m_resident_bytes > limit) {
+                        size_t size = m_lru.back().first;
+                        // the oldest entry of a class is also the first one stashed among that class
+                        auto found = m_classes.find(size);
+                        found->second.pop_front();
+                        if (found->second.empty())
+                            m_classes.erase(found);
+                        m_lru.pop_back();
+                        m_resident_bytes -= size;
+                        counters().resident_bytes -= size;
+                        ++counters().evictions;
+                    }
+                }
+            };
+
             template <class Impl, class Ptr = decltype(std::declval<Impl const>()(size_t{}))>
             struct cached_proxy_f;
 
             template <class Impl, class T, class Deleter>
             struct cached_proxy_f<Impl, std::unique_ptr<T, Deleter>> {
                 using ptr_t = std::unique_ptr<T, Deleter>;
-                using stack_t = std::stack<ptr_t>;
+                using cache_t = cache<ptr_t>;
 
                 struct deleter_f {
                     using pointer = typename ptr_t::pointer;
                     Deleter m_deleter;
-                    stack_t &m_stack;
+                    cache_t &m_cache;
+                    size_t m_size;
 
-                    void operator()(pointer ptr) const { m_stack.emplace(ptr, m_deleter); }
+                    void operator()(pointer ptr) const { m_cache.push(m_size, ptr_t(ptr, m_deleter)); }
                 };
                 using cached_ptr_t = std::unique_ptr<T, deleter_f>;
 
                 Impl m_impl;
 
                 cached_ptr_t operator()(size_t size) const {
-                    static thread_local std::map<size_t, stack_t> stack_map;
-                    auto &stack = stack_map[size];
+                    static thread_local cache_t cache;
+                    size = size_class(size);
                     ptr_t ptr;
-                    if (stack.empty()) {
+                    if (!cache.pop(size, ptr))
                         ptr = m_impl(size);
-                    } else {
-                        ptr = std::move(stack.top());
-                        stack.pop();
-                    }
-                    return {ptr.release(), {ptr.get_deleter(), stack}};
+                    return {ptr.release(), {ptr.get_deleter(), cache, size}};
                 }
             };
         } // namespace allocator_impl_
-    }     // namespace sid
+
+        using cached_allocator_statistics_t = allocator_impl_::cache_statistics;
+
+        inline cached_allocator_statistics_t cached_allocator_statistics() {
+            auto &counters = allocator_impl_::counters();
+            return {counters.hits, counters.misses, counters.evictions, counters.resident_bytes};
+        }
+
+        // The limit applies to the resources stashed by each thread, it is enforced at the next stash
+        inline void set_cached_allocator_limit(size_t bytes) { allocator_impl_::counters().limit = bytes; }
+    } // namespace sid
 } // namespace gridtools
 
 #define GT_FILENAME <gridtools/sid/allocator.hpp>
@@ -122,7 +222,6 @@ namespace gridtools {
                 template <class LazyT>
                 friend auto allocate(allocator &self, LazyT, size_t size) {
                     using type = typename LazyT::type;
-                    auto ptr = self.m_impl(sizeof(type) * size);
                     self.m_buffers.push_back(self.m_impl(sizeof(type) * size));
                     return simple_ptr_holder(reinterpret_cast<type *>(self.m_buffers.back().get()));
                 }
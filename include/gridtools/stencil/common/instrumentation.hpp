@@ -0,0 +1,374 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "../../common/defs.hpp"
+#include "../../common/for_each.hpp"
+#include "../../common/json_escape.hpp"
+#include "../../meta.hpp"
+#include "../../thread_pool/concept.hpp"
+#include "../core/functor_metafunctions.hpp"
+
+/**
+ *   Opt-in per-stage instrumentation of the CPU backends.
+ *
+ *   If the environment variable `GT_STAGE_PROFILE` is set to a file name (or `instrumentation::enable()` is called),
+ *   the backends record the wall time and the number of calls per stage and per thread. The stages are named after
+ *   the functors they execute. With `GT_STAGE_PROFILE_COUNTERS=1`, the Linux hardware counters for cycles,
+ *   instructions and last level cache misses are read as well, the latter are also reported as an estimate of the
+ *   memory traffic in bytes. The results are written as JSON to the file at the program exit, or on demand with
+ *   `instrumentation::write_json`.
+ *
+ *   If the instrumentation is disabled, the overhead is one branch per block and stage.
+ */
+namespace gridtools {
+    namespace stencil {
+        namespace instrumentation {
+            namespace instrumentation_impl_ {
+                constexpr std::size_t num_counters = 3;
+
+                inline char const *const counter_names[num_counters] = {"cycles", "instructions", "llc_misses"};
+
+                inline std::string demangle(char const *name) {
+#ifdef __GNUG__
+                    int status;
+                    std::unique_ptr<char, void (*)(void *)> res(
+                        abi::__cxa_demangle(name, nullptr, nullptr, &status), std::free);
+                    if (status == 0)
+                        return res.get();
+#endif
+                    return name;
+                }
+
+                template <class F>
+                struct functor_name {
+                    static std::string get() { return demangle(typeid(F).name()); }
+                };
+
+                template <class F, class Param>
+                struct functor_name<core::bound_functor<F, Param>> : functor_name<F> {};
+
+                // the names of the functors of all the cells of the stage, joined with `+`
+                template <class Stage>
+                std::string stage_name() {
+                    using cells_t = meta::rename<meta::list, decltype(Stage::cells())>;
+                    std::vector<std::string> names;
+                    for_each<meta::transform<meta::lazy::id, cells_t>>([&](auto cell) {
+                        using funs_t = meta::transform<meta::first, typename decltype(cell)::type::funs_t>;
+                        for_each<meta::transform<meta::lazy::id, funs_t>>([&](auto fun) {
+                            auto name = functor_name<typename decltype(fun)::type>::get();
+                            if (std::find(names.begin(), names.end(), name) == names.end())
+                                names.push_back(std::move(name));
+                        });
+                    });
+                    std::string res;
+                    for (auto const &name : names)
+                        res += (res.empty() ? "" : "+") + name;
+                    return res;
+                }
+
+                /*
+                 *  Hardware counters of the calling thread, as a perf_event group that is read with a single syscall.
+                 */
+                class perf_counters {
+                    int m_fds[num_counters] = {-1, -1, -1};
+
+                  public:
+                    perf_counters() {
+#ifdef __linux__
+                        std::uint64_t configs[num_counters] = {
+                            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES};
+                        for (std::size_t i = 0; i < num_counters; ++i) {
+                            perf_event_attr attr = {};
+                            attr.size = sizeof(attr);
+                            attr.type = PERF_TYPE_HARDWARE;
+                            attr.config = configs[i];
+                            attr.read_format = PERF_FORMAT_GROUP;
+                            attr.exclude_kernel = 1;
+                            attr.exclude_hv = 1;
+                            attr.disabled = i == 0;
+                            m_fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : m_fds[0], 0);
+                            if (m_fds[i] == -1) {
+                                close_all();
+                                return;
+                            }
+                        }
+                        ioctl(m_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+                    }
+
+                    perf_counters(perf_counters const &) = delete;
+                    perf_counters &operator=(perf_counters const &) = delete;
+                    ~perf_counters() { close_all(); }
+
+                    void close_all() {
+#ifdef __linux__
+                        for (auto &fd : m_fds) {
+                            if (fd != -1)
+                                close(fd);
+                            fd = -1;
+                        }
+#endif
+                    }
+
+                    bool read_values(std::uint64_t (&res)[num_counters]) const {
+#ifdef __linux__
+                        std::uint64_t buffer[num_counters + 1];
+                        if (m_fds[0] != -1 && ::read(m_fds[0], buffer, sizeof(buffer)) == sizeof(buffer)) {
+                            for (std::size_t i = 0; i < num_counters; ++i)
+                                res[i] = buffer[i + 1];
+                            return true;
+                        }
+#endif
+                        return false;
+                    }
+
+                    static perf_counters const &get() {
+                        static thread_local perf_counters res;
+                        return res;
+                    }
+                };
+
+                // the maximum number of threads that are measured, the calls of the other threads are not recorded
+                constexpr std::size_t max_threads = 256;
+
+                /*
+                 *  The measurements of a thread. Only the thread itself writes them, the reports may read them
+                 *  concurrently, hence the relaxed atomics. A record fills a cache line on its own.
+                 */
+                struct alignas(64) thread_record {
+                    std::atomic<std::uint64_t> calls{0};
+                    std::atomic<std::uint64_t> nanoseconds{0};
+                    std::atomic<bool> has_counters{false};
+                    std::atomic<std::uint64_t> counters[num_counters] = {};
+
+                    static void add(std::atomic<std::uint64_t> &dst, std::uint64_t value) {
+                        dst.store(dst.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+                    }
+
+                    static std::uint64_t get(std::atomic<std::uint64_t> const &src) {
+                        return src.load(std::memory_order_relaxed);
+                    }
+
+                    void clear() {
+                        calls.store(0, std::memory_order_relaxed);
+                        nanoseconds.store(0, std::memory_order_relaxed);
+                        has_counters.store(false, std::memory_order_relaxed);
+                        for (auto &counter : counters)
+                            counter.store(0, std::memory_order_relaxed);
+                    }
+                };
+
+                // the records of all the threads are allocated at once, running stages keep references to them
+                struct stage_record {
+                    std::string stencil;
+                    std::string name;
+                    std::unique_ptr<thread_record[]> threads{new thread_record[max_threads]};
+                };
+
+                class profiler {
+                    std::mutex m_mutex;
+                    std::atomic<bool> m_enabled{false};
+                    bool m_counters = false;
+                    std::string m_file_name;
+                    std::map<std::pair<std::type_index, std::type_index>, std::unique_ptr<stage_record>> m_index;
+                    std::vector<stage_record *> m_stages;
+
+                  public:
+                    profiler() {
+                        char const *file_name = std::getenv("GT_STAGE_PROFILE");
+                        char const *counters = std::getenv("GT_STAGE_PROFILE_COUNTERS");
+                        if (file_name && *file_name)
+                            enable(counters && std::atoi(counters) != 0, file_name);
+                    }
+
+                    profiler(profiler const &) = delete;
+                    profiler &operator=(profiler const &) = delete;
+
+                    ~profiler() {
+                        if (m_file_name.empty())
+                            return;
+                        std::ofstream file(m_file_name);
+                        if (file)
+                            write_json(file);
+                    }
+
+                    bool counters() const { return m_counters; }
+
+                    void enable(bool counters, std::string file_name = {}) {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_counters = counters;
+                        if (!file_name.empty())
+                            m_file_name = std::move(file_name);
+                        m_enabled = true;
+                    }
+
+                    void disable() { m_enabled = false; }
+
+                    void reset() {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        for (auto *stage : m_stages)
+                            for (std::size_t t = 0; t != max_threads; ++t)
+                                stage->threads[t].clear();
+                    }
+
+                    // the record of the stage, nullptr if the instrumentation is disabled
+                    template <class Spec, class Stage>
+                    stage_record *stage() {
+                        if (!m_enabled)
+                            return nullptr;
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        auto &res = m_index[{typeid(Spec), typeid(Stage)}];
+                        if (!res) {
+                            char stencil[17];
+                            std::snprintf(stencil, sizeof(stencil), "%016zx", typeid(Spec).hash_code());
+                            res.reset(new stage_record{stencil, stage_name<Stage>()});
+                            m_stages.push_back(res.get());
+                        }
+                        return res.get();
+                    }
+
+                    void write_json(std::ostream &sink) {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        sink << "{\"stages\": [";
+                        for (std::size_t s = 0; s != m_stages.size(); ++s) {
+                            auto const &stage = *m_stages[s];
+                            std::uint64_t calls = 0;
+                            std::uint64_t nanoseconds = 0;
+                            std::size_t num_threads = 0;
+                            for (std::size_t t = 0; t != max_threads; ++t) {
+                                auto const &thread = stage.threads[t];
+                                if (!thread.get(thread.calls))
+                                    continue;
+                                calls += thread.get(thread.calls);
+                                nanoseconds += thread.get(thread.nanoseconds);
+                                num_threads = t + 1;
+                            }
+                            sink << (s ? ",\n" : "\n") << "  {\"stencil\": \"" << stage.stencil << "\", \"stage\": \""
+                                 << json_escape(stage.name) << "\", \"calls\": " << calls
+                                 << ", \"thread_seconds\": " << nanoseconds * 1e-9 << ", \"threads\": [";
+                            for (std::size_t t = 0; t != num_threads; ++t) {
+                                auto const &thread = stage.threads[t];
+                                sink << (t ? ", " : "") << "{\"thread\": " << t
+                                     << ", \"calls\": " << thread.get(thread.calls)
+                                     << ", \"seconds\": " << thread.get(thread.nanoseconds) * 1e-9;
+                                if (thread.has_counters.load(std::memory_order_relaxed)) {
+                                    std::uint64_t counters[num_counters];
+                                    for (std::size_t c = 0; c != num_counters; ++c) {
+                                        counters[c] = thread.get(thread.counters[c]);
+                                        sink << ", \"" << counter_names[c] << "\": " << counters[c];
+                                    }
+                                    // every miss is assumed to transfer one cache line
+                                    sink << ", \"llc_miss_bytes\": " << counters[num_counters - 1] * 64;
+                                }
+                                sink << "}";
+                            }
+                            sink << "]}";
+                        }
+                        sink << "\n]}" << std::endl;
+                    }
+
+                    static profiler &get() {
+                        static profiler res;
+                        return res;
+                    }
+                };
+
+                // Measures the enclosing scope and accumulates the results to the record of the thread
+                class scope_timer {
+                    thread_record &m_record;
+                    perf_counters const *m_counters;
+                    std::uint64_t m_start_counters[num_counters] = {};
+                    std::chrono::steady_clock::time_point m_start;
+
+                  public:
+                    scope_timer(thread_record &record, bool counters)
+                        : m_record(record), m_counters(counters ? &perf_counters::get() : nullptr) {
+                        if (m_counters && !m_counters->read_values(m_start_counters))
+                            m_counters = nullptr;
+                        m_start = std::chrono::steady_clock::now();
+                    }
+
+                    scope_timer(scope_timer const &) = delete;
+                    scope_timer &operator=(scope_timer const &) = delete;
+
+                    ~scope_timer() {
+                        auto elapsed = std::chrono::steady_clock::now() - m_start;
+                        m_record.add(m_record.calls, 1);
+                        m_record.add(m_record.nanoseconds,
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+                        std::uint64_t values[num_counters];
+                        if (m_counters && m_counters->read_values(values)) {
+                            m_record.has_counters.store(true, std::memory_order_relaxed);
+                            for (std::size_t i = 0; i < num_counters; ++i)
+                                m_record.add(m_record.counters[i], values[i] - m_start_counters[i]);
+                        }
+                    }
+                };
+
+                /*
+                 *  Wraps the loop of a stage, such that each call is measured if the instrumentation is enabled.
+                 *  The loop is called by the threads of the pool.
+                 */
+                template <class Spec, class Stage, class ThreadPool, class Loop>
+                auto instrument(ThreadPool, Loop loop) {
+                    auto &prof = profiler::get();
+                    return [loop = std::move(loop),
+                               record = prof.template stage<Spec, Stage>(),
+                               counters = prof.counters()](auto &&...args) {
+                        if (!record)
+                            return loop(std::forward<decltype(args)>(args)...);
+                        std::size_t thread = thread_pool::get_thread_num(ThreadPool());
+                        if (thread >= max_threads)
+                            return loop(std::forward<decltype(args)>(args)...);
+                        scope_timer timer(record->threads[thread], counters);
+                        loop(std::forward<decltype(args)>(args)...);
+                    };
+                }
+            } // namespace instrumentation_impl_
+
+            using instrumentation_impl_::instrument;
+            using instrumentation_impl_::stage_name;
+
+            inline void enable(bool counters = false) { instrumentation_impl_::profiler::get().enable(counters); }
+            inline void disable() { instrumentation_impl_::profiler::get().disable(); }
+            inline void reset() { instrumentation_impl_::profiler::get().reset(); }
+            inline void write_json(std::ostream &sink) { instrumentation_impl_::profiler::get().write_json(sink); }
+        } // namespace instrumentation
+    }     // namespace stencil
+} // namespace gridtools
@@ -9,10 +9,12 @@
  */
 #pragma once
 
+#include <cstddef>
 #include <type_traits>
 #include <utility>
 
 #include "../../common/defs.hpp"
+#include "../../common/for_each.hpp"
 #include "../../common/hymap.hpp"
 #include "../../common/integral_constant.hpp"
 #include "../../common/tuple_util.hpp"
@@ -24,6 +26,7 @@
 #include "../../thread_pool/omp.hpp"
 #include "../be_api.hpp"
 #include "../common/dim.hpp"
+#include "../common/instrumentation.hpp"
 #include "execinfo.hpp"
 #include "loops.hpp"
 #include "pos3.hpp"
@@ -48,9 +51,15 @@ namespace gridtools {
 
                     tmp_allocator alloc;
 
-                    execinfo info(ThreadPool(), grid);
-
                     using tmp_plh_map_t = be_api::remove_caches_from_plh_map<typename stages_t::tmp_plh_map_t>;
+
+                    // the temporaries of k-serial stages hold whole columns
+                    std::size_t column_bytes = 0;
+                    for_each<tmp_plh_map_t>([&](auto info) { column_bytes += sizeof(decltype(info.data())); });
+                    if (!fuse_all_t::value)
+                        column_bytes *= grid.k_size();
+
+                    execinfo info(ThreadPool(), grid, column_bytes);
                     auto temporaries = be_api::make_data_stores(tmp_plh_map_t(),
                         [&alloc,
                             block_size = make_pos3(
@@ -84,12 +93,13 @@ namespace gridtools {
                                     return sid::add_const(info.is_const(), at_key<decltype(info.plh())>(data_stores));
                                 },
                                 stage_t::plh_map()));
-                            return make_loop<ThreadPool, stage_t>(
-                                fuse_all_t(), grid, std::move(composite), std::move(k_sizes));
+                            return instrumentation::instrument<Spec, stage_t>(ThreadPool(),
+                                make_loop<ThreadPool, stage_t>(
+                                    fuse_all_t(), grid, std::move(composite), std::move(k_sizes)));
                         },
                         meta::rename<tuple, stages_t>());
 
-                    run_loops<ThreadPool>(fuse_all_t(), grid, std::move(loops));
+                    run_loops<ThreadPool>(fuse_all_t(), grid, info, std::move(loops));
                 }
             };
         } // namespace cpu_ifirst_backend
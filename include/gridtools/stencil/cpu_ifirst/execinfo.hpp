@@ -10,8 +10,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
 #include "../../common/defs.hpp"
 #include "../../common/host_device.hpp"
+#include "../../common/hugepage_alloc.hpp"
 #include "../../thread_pool/concept.hpp"
 
 namespace gridtools {
@@ -42,31 +47,61 @@ namespace gridtools {
 
             /**
              * @brief Helper class for block handling.
+             *
+             * The block sizes are chosen such that the temporaries of a block stay resident in (half of) the L2
+             * cache. The domain is over-decomposed into several blocks per thread, the blocks are meant to be
+             * scheduled dynamically for load balancing.
              */
             class execinfo {
                 int_t m_i_grid_size, m_j_grid_size;
                 int_t m_i_block_size, m_j_block_size;
                 int_t m_i_blocks, m_j_blocks;
 
+                /** Minimal number of blocks per thread, if the domain is large enough. */
+                static constexpr int_t blocks_per_thread = 4;
+                /** The blocks are not split along i-axis below that size (for vectorization reasons). */
+                static constexpr int_t min_i_block_size = 8;
+
                 GT_FORCE_INLINE static int_t clamped_block_size(
                     int_t grid_size, int_t block_index, int_t block_size, int_t blocks) {
                     return (block_index == blocks - 1) ? grid_size - block_index * block_size : block_size;
                 }
 
+                GT_FORCE_INLINE static int_t num_blocks(int_t grid_size, int_t block_size) {
+                    return (grid_size + block_size - 1) / block_size;
+                }
+
               public:
+                /**
+                 * @param column_bytes Size of the temporaries per (i, j) point of a block in bytes, zero if there are
+                 * no temporaries.
+                 */
                 template <class ThreadPool, class Grid>
-                GT_FORCE_INLINE execinfo(ThreadPool, const Grid &grid)
+                execinfo(ThreadPool, const Grid &grid, std::size_t column_bytes = 0)
                     : m_i_grid_size(grid.i_size()), m_j_grid_size(grid.j_size()) {
+                    assert(m_i_grid_size > 0 && m_j_grid_size > 0);
                     int_t threads = thread_pool::get_max_threads(ThreadPool());
 
-                    // if domain is large enough (relative to the number of threads),
-                    // we split only along j-axis (for prefetching reasons)
-                    // for smaller domains we also split along i-axis
-                    m_j_block_size = (m_j_grid_size + threads - 1) / threads;
-                    m_j_blocks = (m_j_grid_size + m_j_block_size - 1) / m_j_block_size;
-                    int_t max_i_blocks = threads / m_j_blocks;
-                    m_i_block_size = (m_i_grid_size + max_i_blocks - 1) / max_i_blocks;
-                    m_i_blocks = (m_i_grid_size + m_i_block_size - 1) / m_i_block_size;
+                    // whole rows along i-axis are preferred (for prefetching reasons), the rest of the cache budget
+                    // goes along j-axis
+                    int_t max_points = m_i_grid_size * m_j_grid_size;
+                    if (column_bytes != 0)
+                        max_points = std::clamp<int_t>(l2_cache_size() / 2 / column_bytes, 1, max_points);
+                    m_i_block_size = std::min(m_i_grid_size, max_points);
+                    m_j_block_size = std::clamp<int_t>(max_points / m_i_block_size, 1, m_j_grid_size);
+
+                    // over-decomposition, first along j-axis, then along i-axis
+                    auto too_few_blocks = [&] {
+                        return num_blocks(m_i_grid_size, m_i_block_size) * num_blocks(m_j_grid_size, m_j_block_size) <
+                               blocks_per_thread * threads;
+                    };
+                    while (too_few_blocks() && m_j_block_size > 1)
+                        m_j_block_size = (m_j_block_size + 1) / 2;
+                    while (too_few_blocks() && m_i_block_size > min_i_block_size)
+                        m_i_block_size = (m_i_block_size + 1) / 2;
+
+                    m_i_blocks = num_blocks(m_i_grid_size, m_i_block_size);
+                    m_j_blocks = num_blocks(m_j_grid_size, m_j_block_size);
 
                     assert(m_i_block_size > 0 && m_j_block_size > 0);
                 }
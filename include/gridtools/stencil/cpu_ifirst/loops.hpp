@@ -9,6 +9,9 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <type_traits>
 #include <utility>
 
@@ -97,19 +100,52 @@ namespace gridtools {
                     };
                 }
 
+                struct alignas(64) index_range {
+                    std::atomic<int_t> next;
+                    int_t end;
+                };
+
+                /**
+                 * @brief Calls `f(index)` for all indices in [0, size). Every thread starts on its own contiguous range
+                 * of indices, which keeps the data it touches on the local NUMA node. Threads that are done take the
+                 * remaining indices of the others, hence slow threads get less work. The range a thread starts on is
+                 * selected by its thread number, not by the loop index it got from the pool, hence it matches the first
+                 * touch of the storages (see `storage::builder`) for any schedule of the thread pool.
+                 */
+                template <class ThreadPool, class F>
+                void dynamic_for_loop(F const &f, int_t size) {
+                    int_t threads = std::min<int_t>(thread_pool::get_max_threads(ThreadPool()), size);
+                    std::unique_ptr<index_range[]> ranges(new index_range[threads]);
+                    for (int_t t = 0; t < threads; ++t) {
+                        ranges[t].next = size * t / threads;
+                        ranges[t].end = size * (t + 1) / threads;
+                    }
+                    thread_pool::parallel_for_loop(
+                        ThreadPool(),
+                        [&](auto) {
+                            int_t thread = thread_pool::get_thread_num(ThreadPool());
+                            for (int_t t = 0; t < threads; ++t) {
+                                auto &range = ranges[(thread + t) % threads];
+                                for (int_t index = range.next++; index < range.end; index = range.next++)
+                                    f(index);
+                            }
+                        },
+                        threads);
+                }
+
                 template <class ThreadPool, class Grid, class Loops>
-                void run_loops(std::true_type, Grid const &grid, Loops loops) {
-                    execinfo info(ThreadPool(), grid);
+                void run_loops(std::true_type, Grid const &grid, execinfo const &info, Loops loops) {
                     int_t i_blocks = info.i_blocks();
                     int_t j_blocks = info.j_blocks();
                     int_t k_size = grid.k_size();
-                    thread_pool::parallel_for_loop(ThreadPool(),
-                        [&](auto i, auto k, auto j) {
+                    dynamic_for_loop<ThreadPool>(
+                        [&](int_t index) {
+                            int_t i = index % i_blocks;
+                            int_t k = index / i_blocks % k_size;
+                            int_t j = index / i_blocks / k_size;
                             tuple_util::for_each([block = info.block(i, j, k)](auto &&loop) { loop(block); }, loops);
                         },
-                        i_blocks,
-                        k_size,
-                        j_blocks);
+                        i_blocks * k_size * j_blocks);
                 }
 
                 template <class ThreadPool, class Stage, class Grid, class Composite, class KSizes>
@@ -149,14 +185,14 @@ namespace gridtools {
                 }
 
                 template <class ThreadPool, class Grid, class Loops>
-                void run_loops(std::false_type, Grid const &grid, Loops loops) {
-                    execinfo info(ThreadPool(), grid);
-                    thread_pool::parallel_for_loop(ThreadPool(),
-                        [&](auto i, auto j) {
-                            tuple_util::for_each([block = info.block(i, j)](auto &&loop) { loop(block); }, loops);
+                void run_loops(std::false_type, Grid const &, execinfo const &info, Loops loops) {
+                    int_t i_blocks = info.i_blocks();
+                    dynamic_for_loop<ThreadPool>(
+                        [&](int_t index) {
+                            auto block = info.block(index % i_blocks, index / i_blocks);
+                            tuple_util::for_each([&block](auto &&loop) { loop(block); }, loops);
                         },
-                        info.i_blocks(),
-                        info.j_blocks());
+                        i_blocks * info.j_blocks());
                 }
             } // namespace loops_impl_
             using loops_impl_::make_loop;
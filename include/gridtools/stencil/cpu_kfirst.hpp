@@ -9,12 +9,15 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <memory>
+#include <type_traits>
 #include <utility>
 
 #include "../common/defs.hpp"
 #include "../common/for_each.hpp"
 #include "../common/host_device.hpp"
+#include "../common/hymap.hpp"
 #include "../common/integral_constant.hpp"
 #include "../common/tuple.hpp"
 #include "../common/tuple_util.hpp"
@@ -31,46 +34,107 @@
 #include "../thread_pool/omp.hpp"
 #include "be_api.hpp"
 #include "common/dim.hpp"
+#include "common/caches.hpp"
+#include "common/instrumentation.hpp"
+#include "cpu_kfirst/k_cache.hpp"
 
 namespace gridtools {
     namespace stencil {
         namespace cpu_kfirst_backend {
-            template <class ThreadPool, class Stage, class Grid, class DataStores>
+            template <class Stages, class ThreadPool, class Stage, class Grid, class DataStores>
             auto make_stage_loop(ThreadPool, Stage, Grid const &grid, DataStores &data_stores) {
                 using extent_t = typename Stage::extent_t;
 
                 using plh_map_t = typename Stage::plh_map_t;
-                using keys_t = meta::rename<sid::composite::keys, meta::transform<meta::first, plh_map_t>>;
-                auto composite = tuple_util::convert_to<keys_t::template values>(tuple_util::transform(
-                    [&](auto info) GT_FORCE_INLINE_LAMBDA {
-                        return sid::add_const(info.is_const(), at_key<decltype(info.plh())>(data_stores));
-                    },
-                    Stage::plh_map()));
+                // the k-caches that are synced with memory also need the fields themselves
+                using synced_plh_map_t = meta::filter<is_synced_k_cache_f<Stages>::template apply, plh_map_t>;
+                using keys_t = meta::rename<sid::composite::keys,
+                    meta::concat<meta::transform<meta::first, plh_map_t>, meta::transform<orig_key, synced_plh_map_t>>>;
+                auto composite = tuple_util::convert_to<keys_t::template values>(tuple_util::concat(
+                    tuple_util::transform(
+                        [&](auto info) GT_FORCE_INLINE_LAMBDA {
+                            if constexpr (is_local_k_cache_f<Stages>::template apply<decltype(info)>::value)
+                                return k_cache_sid_t();
+                            else
+                                return sid::add_const(info.is_const(), at_key<decltype(info.plh())>(data_stores));
+                        },
+                        Stage::plh_map()),
+                    tuple_util::transform(
+                        [&](auto info) GT_FORCE_INLINE_LAMBDA {
+                            using policies_t = typename decltype(info)::cache_io_policies_t;
+                            using is_const_t = std::negation<meta::st_contains<policies_t, cache_io_policy::flush>>;
+                            return sid::add_const(is_const_t(), at_key<decltype(info.plh())>(data_stores));
+                        },
+                        meta::rename<tuple, synced_plh_map_t>())));
                 using ptr_diff_t = sid::ptr_diff_type<decltype(composite)>;
 
                 auto strides = sid::get_strides(composite);
                 ptr_diff_t offset{};
                 sid::shift(offset, sid::get_stride<dim::i>(strides), extent_t::minus(dim::i()));
                 sid::shift(offset, sid::get_stride<dim::j>(strides), extent_t::minus(dim::j()));
-                sid::shift(
-                    offset, sid::get_stride<dim::k>(strides), grid.k_start(Stage::interval(), Stage::execution()));
+                int_t k_start = grid.k_start(Stage::interval(), Stage::execution());
+                sid::shift(offset, sid::get_stride<dim::k>(strides), k_start);
+
+                // the levels that the k-caches may be synced with: the k bounds of the fields
+                auto k_bounds = tuple_util::transform(
+                    [&](auto info) GT_FORCE_INLINE_LAMBDA {
+                        auto const &data_store = at_key<decltype(info.plh())>(data_stores);
+                        return tuple<int_t, int_t>(
+                            sid::get_lower_bound<dim::k>(sid::get_lower_bounds(data_store)),
+                            sid::get_upper_bound<dim::k>(sid::get_upper_bounds(data_store)));
+                    },
+                    hymap::from_keys_values<meta::transform<orig_key, synced_plh_map_t>, synced_plh_map_t>());
 
-                auto shift_back = -grid.k_size(Stage::interval()) * Stage::k_step();
+                int_t k_size = grid.k_size(Stage::interval());
+                auto shift_back = -k_size * Stage::k_step();
                 auto k_sizes = tuple_util::transform(
                     [&](auto cell) GT_FORCE_INLINE_LAMBDA { return grid.k_size(cell.interval()); }, Stage::cells());
-                auto k_loop = [k_sizes = std::move(k_sizes), shift_back](auto &ptr, auto const &strides)
-                                  GT_FORCE_INLINE_LAMBDA {
-                                      tuple_util::for_each(
-                                          [&ptr, &strides](auto cell, auto size) GT_FORCE_INLINE_LAMBDA {
-                                              for (int_t k = 0; k < size; ++k) {
-                                                  cell(ptr, strides);
-                                                  cell.inc_k(ptr, strides);
-                                              }
-                                          },
-                                          Stage::cells(),
-                                          k_sizes);
-                                      sid::shift(ptr, sid::get_stride<dim::k>(strides), shift_back);
-                                  };
+                auto k_loop = [k_sizes = std::move(k_sizes),
+                                  shift_back,
+                                  k_bounds = std::move(k_bounds),
+                                  k_start,
+                                  k_size](auto &ptr, auto const &strides) GT_FORCE_INLINE_LAMBDA {
+                    if constexpr (has_k_caches<Stages, Stage>::value) {
+                        // the k-cached fields are accessed in the rolling buffers, that are slid instead of shifting
+                        // the pointers; the levels are loaded when they enter the window and stored when they leave it
+                        auto step = Stage::k_step();
+                        int_t k_last = k_start + (k_size - 1) * step;
+                        int_t lo = std::min(k_start, k_last);
+                        int_t hi = std::max(k_start, k_last);
+                        int_t k = k_start;
+                        k_caches_type<Stages, Stage> k_caches;
+                        auto mixed_ptr = hymap::merge(k_caches.ptr(), ptr);
+                        auto &mem_ptr = mixed_ptr.secondary();
+                        k_caches.fill(whole_window(), step, mem_ptr, strides, k, k_bounds);
+                        tuple_util::for_each(
+                            [&](auto cell, auto size) GT_FORCE_INLINE_LAMBDA {
+                                for (int_t i = 0; i < size; ++i) {
+                                    cell(mixed_ptr, strides);
+                                    if (k == k_last)
+                                        break;
+                                    k_caches.flush(trailing_edge(), step, mem_ptr, strides, k, k_bounds, lo, hi);
+                                    k_caches.slide(step);
+                                    cell.inc_k(mem_ptr, strides);
+                                    k += step;
+                                    k_caches.fill(leading_edge(), step, mem_ptr, strides, k, k_bounds);
+                                }
+                            },
+                            Stage::cells(),
+                            k_sizes);
+                        k_caches.flush(whole_window(), step, mem_ptr, strides, k, k_bounds, lo, hi);
+                    } else {
+                        tuple_util::for_each(
+                            [&ptr, &strides](auto cell, auto size) GT_FORCE_INLINE_LAMBDA {
+                                for (int_t k = 0; k < size; ++k) {
+                                    cell(ptr, strides);
+                                    cell.inc_k(ptr, strides);
+                                }
+                            },
+                            Stage::cells(),
+                            k_sizes);
+                        sid::shift(ptr, sid::get_stride<dim::k>(strides), shift_back);
+                    }
+                };
                 return [origin = sid::get_origin(composite) + offset,
                            strides = std::move(strides),
                            k_loop = std::move(k_loop)](int_t i_block, int_t j_block, int_t i_size, int_t j_size) {
@@ -99,7 +163,9 @@ namespace gridtools {
 
                 auto alloc = sid::cached_allocator(&std::make_unique<char[]>);
 
-                using tmp_plh_map_t = be_api::remove_caches_from_plh_map<typename stages_t::tmp_plh_map_t>;
+                // temporaries that are only accessed via k-caches that are never synced are not allocated
+                using tmp_plh_map_t = be_api::remove_caches_from_plh_map<
+                    meta::filter<is_allocated_tmp_f<stages_t>::template apply, typename stages_t::tmp_plh_map_t>>;
                 auto temporaries = be_api::make_data_stores(tmp_plh_map_t(), [&grid, &alloc](auto info) {
                     auto extent = info.extent();
                     auto interval = stages_t::interval();
@@ -128,8 +194,10 @@ namespace gridtools {
                 auto data_stores = hymap::concat(std::move(blocked_external_data_stores), std::move(temporaries));
 
                 auto stage_loops = tuple_util::transform(
-                    [&](auto stage)
-                        GT_FORCE_INLINE_LAMBDA { return make_stage_loop(ThreadPool(), stage, grid, data_stores); },
+                    [&](auto stage) GT_FORCE_INLINE_LAMBDA {
+                        return instrumentation::instrument<Spec, decltype(stage)>(
+                            ThreadPool(), make_stage_loop<stages_t>(ThreadPool(), stage, grid, data_stores));
+                    },
                     meta::rename<tuple, stages_t>());
 
                 int_t total_i = grid.i_size();
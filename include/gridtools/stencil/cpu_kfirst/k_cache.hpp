@@ -0,0 +1,258 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+#include "../../common/defs.hpp"
+#include "../../common/for_each.hpp"
+#include "../../common/host_device.hpp"
+#include "../../common/hymap.hpp"
+#include "../../common/integral_constant.hpp"
+#include "../../common/tuple_util.hpp"
+#include "../../meta.hpp"
+#include "../../sid/concept.hpp"
+#include "../common/caches.hpp"
+#include "../common/dim.hpp"
+
+namespace gridtools {
+    namespace stencil {
+        namespace cpu_kfirst_backend {
+            namespace k_cache_impl_ {
+                // Rolling window of the values of a k-cached field in the levels [k + Minus, k + Plus]
+                template <class T, int_t Minus, int_t Plus>
+                struct storage {
+                    static constexpr int_t minus = Minus;
+                    static constexpr int_t plus = Plus;
+
+                    T m_values[Plus - Minus + 1] = {};
+
+                    storage() = default;
+                    storage(storage const &) = delete;
+                    storage(storage &&) = default;
+
+                    template <class Step, std::enable_if_t<Step::value == 1, int> = 0>
+                    GT_FORCE_INLINE void slide(Step) {
+                        for (int_t k = 0; k < Plus - Minus; ++k)
+                            m_values[k] = m_values[k + 1];
+                    }
+
+                    template <class Step, std::enable_if_t<Step::value == -1, int> = 0>
+                    GT_FORCE_INLINE void slide(Step) {
+                        for (int_t k = Plus - Minus; k > 0; --k)
+                            m_values[k] = m_values[k - 1];
+                    }
+
+                    GT_FORCE_INLINE T *ptr() { return m_values - Minus; }
+                };
+
+                // Placeholder SID for the k-cached fields in the composite, it provides the unit k stride
+                struct fake {
+                    fake operator()() const { return {}; }
+                    fake operator*() const;
+                };
+                fake sid_get_ptr_diff(fake);
+                inline fake sid_get_origin(fake) { return {}; }
+                inline fake operator+(fake, fake) { return {}; }
+                inline hymap::keys<dim::k>::values<integral_constant<int_t, 1>> sid_get_strides(fake) { return {}; }
+
+                static_assert(is_sid<fake>(), GT_INTERNAL_ERROR);
+
+                template <class PlhInfo, class Extent = typename PlhInfo::extent_t>
+                using make_storage_type =
+                    storage<typename PlhInfo::data_t, Extent::kminus::value, Extent::kplus::value>;
+
+                template <class PlhInfo>
+                using is_k_cached = std::is_same<typename PlhInfo::caches_t, meta::list<cache_type::k>>;
+
+                template <class Key>
+                struct has_key_f {
+                    template <class Stage>
+                    using apply = meta::st_contains<meta::transform<meta::first, typename Stage::plh_map_t>, Key>;
+                };
+
+                /*
+                 *  The stages of the split view are processed one after another for the whole column, hence a k-cache
+                 *  can only be kept in a rolling buffer if all the accesses through it happen within a single stage.
+                 *  The fill and flush policies sync such a buffer with the field in memory, the accesses of the other
+                 *  multistages to the field are not cached. The other k-cached fields are accessed in memory, like the
+                 *  uncached ones.
+                 */
+                template <class Stages>
+                struct is_local_k_cache_f {
+                    template <class PlhInfo,
+                        class Users = meta::filter<has_key_f<typename PlhInfo::key_t>::template apply, Stages>>
+                    using apply = std::bool_constant<is_k_cached<PlhInfo>::value && meta::length<Users>::value == 1>;
+                };
+
+                template <class Stages, class Stage>
+                using has_k_caches =
+                    meta::any_of<is_local_k_cache_f<Stages>::template apply, typename Stage::plh_map_t>;
+
+                // the key of the field in memory of a k-cached placeholder
+                template <class PlhInfo>
+                using orig_key = meta::list<typename PlhInfo::plh_t>;
+
+                template <class Policy>
+                struct has_policy_f {
+                    template <class PlhInfo>
+                    using apply = meta::st_contains<typename PlhInfo::cache_io_policies_t, Policy>;
+                };
+
+                // local k-caches that are filled from or flushed to the field in memory
+                template <class Stages>
+                struct is_synced_k_cache_f {
+                    template <class PlhInfo>
+                    using apply = std::bool_constant<is_local_k_cache_f<Stages>::template apply<PlhInfo>::value &&
+                                                     !meta::is_empty<typename PlhInfo::cache_io_policies_t>::value>;
+                };
+
+                // the temporaries that are accessed in memory, either directly or to sync a k-cache
+                template <class Stages>
+                struct is_allocated_tmp_f {
+                    template <class PlhInfo>
+                    using apply = std::bool_constant<!is_local_k_cache_f<Stages>::template apply<PlhInfo>::value ||
+                                                     is_synced_k_cache_f<Stages>::template apply<PlhInfo>::value>;
+                };
+
+                // The levels of the window that are synced, relative to the current level
+                struct whole_window {
+                    static constexpr int_t from(int_t minus, int_t, int_t) { return minus; }
+                    static constexpr int_t to(int_t, int_t plus, int_t) { return plus; }
+                };
+
+                // the level that enters the window when it is slid in the direction `step`
+                struct leading_edge {
+                    static constexpr int_t from(int_t minus, int_t plus, int_t step) {
+                        return step > 0 ? plus : minus;
+                    }
+                    static constexpr int_t to(int_t minus, int_t plus, int_t step) {
+                        return from(minus, plus, step);
+                    }
+                };
+
+                // the level that leaves the window when it is slid in the direction `step`
+                struct trailing_edge {
+                    static constexpr int_t from(int_t minus, int_t plus, int_t step) {
+                        return step > 0 ? minus : plus;
+                    }
+                    static constexpr int_t to(int_t minus, int_t plus, int_t step) {
+                        return from(minus, plus, step);
+                    }
+                };
+
+                /*
+                 *  The rolling buffers of the local k-caches of a stage. The buffers of the filled caches are loaded
+                 *  from memory when a level enters the window, the buffers of the flushed caches are stored when a
+                 *  level leaves it. `ptr` and `strides` give access to the fields in memory by `orig_key`, `lo` and
+                 *  `hi` bound the levels that may be synced. Only the caches of `SyncedPlhMap` are synced.
+                 */
+                template <class PlhMap, class SyncedPlhMap>
+                class k_caches {
+                    using keys_t = meta::transform<meta::first, PlhMap>;
+                    using storages_t = meta::transform<make_storage_type, PlhMap>;
+
+                    hymap::from_keys_values<keys_t, storages_t> m_storages;
+
+                    template <class Policy, class Window, class Step, class Ptr, class Strides, class Bounds>
+                    GT_FORCE_INLINE void sync(Window,
+                        Step step,
+                        Ptr const &ptr,
+                        Strides const &strides,
+                        int_t k,
+                        Bounds const &bounds,
+                        int_t lo,
+                        int_t hi) {
+                        using infos_t = meta::filter<has_policy_f<Policy>::template apply, SyncedPlhMap>;
+                        for_each<infos_t>([&](auto info) GT_FORCE_INLINE_LAMBDA {
+                            using info_t = decltype(info);
+                            using key_t = orig_key<info_t>;
+                            auto &storage = at_key<typename info_t::key_t>(m_storages);
+                            using storage_t = std::decay_t<decltype(storage)>;
+                            auto const &bound = at_key<key_t>(bounds);
+                            int_t from = std::max(Window::from(storage_t::minus, storage_t::plus, step),
+                                std::max(lo, tuple_util::get<0>(bound)) - k);
+                            int_t to = std::min(Window::to(storage_t::minus, storage_t::plus, step),
+                                std::min(hi, tuple_util::get<1>(bound) - 1) - k);
+                            auto orig = at_key<key_t>(ptr);
+                            auto stride = sid::get_stride_element<key_t, dim::k>(strides);
+                            for (int_t offset = from; offset <= to; ++offset) {
+                                if constexpr (std::is_same_v<Policy, cache_io_policy::fill>)
+                                    storage.ptr()[offset] = *sid::shifted(orig, stride, offset);
+                                else
+                                    *sid::shifted(orig, stride, offset) = storage.ptr()[offset];
+                            }
+                        });
+                    }
+
+                  public:
+                    GT_FORCE_INLINE auto ptr() {
+                        return tuple_util::transform(
+                            [](auto &storage) GT_FORCE_INLINE_LAMBDA { return storage.ptr(); }, m_storages);
+                    }
+
+                    template <class Step>
+                    GT_FORCE_INLINE void slide(Step step) {
+                        tuple_util::for_each(
+                            [step](auto &storage) GT_FORCE_INLINE_LAMBDA { storage.slide(step); }, m_storages);
+                    }
+
+                    // loads the levels of `window` that are within the bounds of the fields
+                    template <class Window, class Step, class Ptr, class Strides, class Bounds>
+                    GT_FORCE_INLINE void fill(Window window,
+                        Step step,
+                        Ptr const &ptr,
+                        Strides const &strides,
+                        int_t k,
+                        Bounds const &bounds) {
+                        sync<cache_io_policy::fill>(window,
+                            step,
+                            ptr,
+                            strides,
+                            k,
+                            bounds,
+                            std::numeric_limits<int_t>::min(),
+                            std::numeric_limits<int_t>::max());
+                    }
+
+                    // stores the levels of `window` that are within the bounds of the fields and within [lo, hi]
+                    template <class Window, class Step, class Ptr, class Strides, class Bounds>
+                    GT_FORCE_INLINE void flush(Window window,
+                        Step step,
+                        Ptr const &ptr,
+                        Strides const &strides,
+                        int_t k,
+                        Bounds const &bounds,
+                        int_t lo,
+                        int_t hi) {
+                        sync<cache_io_policy::flush>(window, step, ptr, strides, k, bounds, lo, hi);
+                    }
+                };
+
+                template <class Stages, class Stage, class PlhMap = typename Stage::plh_map_t>
+                using k_caches_type = k_caches<meta::filter<is_local_k_cache_f<Stages>::template apply, PlhMap>,
+                    meta::filter<is_synced_k_cache_f<Stages>::template apply, PlhMap>>;
+            } // namespace k_cache_impl_
+
+            using k_cache_sid_t = k_cache_impl_::fake;
+            using k_cache_impl_::has_k_caches;
+            using k_cache_impl_::is_allocated_tmp_f;
+            using k_cache_impl_::is_local_k_cache_f;
+            using k_cache_impl_::is_synced_k_cache_f;
+            using k_cache_impl_::k_caches_type;
+            using k_cache_impl_::leading_edge;
+            using k_cache_impl_::orig_key;
+            using k_cache_impl_::trailing_edge;
+            using k_cache_impl_::whole_window;
+        } // namespace cpu_kfirst_backend
+    }     // namespace stencil
+} // namespace gridtools
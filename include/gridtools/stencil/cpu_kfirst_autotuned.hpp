@@ -0,0 +1,328 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <forward_list>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <tuple>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include "../common/ct_dispatch.hpp"
+#include "../common/defs.hpp"
+#include "../common/for_each.hpp"
+#include "../common/integral_constant.hpp"
+#include "../meta.hpp"
+#include "../thread_pool/omp.hpp"
+#include "cpu_kfirst.hpp"
+
+/**
+ *   Autotuning wrapper of the `cpu_kfirst` backend.
+ *
+ *   `cpu_kfirst_autotuned<BlockSizes, ThreadPool, Trials>` instantiates `cpu_kfirst` for every candidate in the list
+ *   `BlockSizes` of `block_sizes<I, J>` and dispatches between them at run time. The first `Trials` invocations per
+ *   candidate of a stencil on a given domain size are timed, the candidates are run in a round-robin fashion. After
+ *   that, the fastest candidate is used for all the following invocations.
+ *
+ *   If the environment variable `GT_AUTOTUNE_CACHE` is set to a file name, the winners are persisted in that file and
+ *   read back at the first use of the backend. The entries are keyed by the stencil type and the domain size, hence the
+ *   tuning is done only once for every pair. If the stored winner is not among the candidates, the stencil is retuned.
+ *   If the file can not be written, the winners are kept in memory only. The file is rewritten as a whole through a
+ *   temporary file and a rename, hence several processes (e.g. MPI ranks) can share it without corrupting it.
+ *
+ *   The stencil part of the key is a hash of `typeid(Spec).name()`. The type names are compiler and ABI specific, a
+ *   cache file is therefore only meaningful for binaries built with the same compiler. Entries written by another
+ *   compiler do not match and the stencils are simply retuned.
+ *
+ *   Once the tuning of a stencil on a domain size has converged, the winner is published per stencil and the following
+ *   invocations on that domain size dispatch without locking.
+ */
+namespace gridtools {
+    namespace stencil {
+        namespace cpu_kfirst_backend {
+            namespace autotune_impl_ {
+                template <int_t I, int_t J>
+                using block_sizes = meta::list<integral_constant<int_t, I>, integral_constant<int_t, J>>;
+
+                using default_block_sizes = meta::list<block_sizes<8, 8>,
+                    block_sizes<4, 4>,
+                    block_sizes<16, 8>,
+                    block_sizes<8, 16>,
+                    block_sizes<16, 16>,
+                    block_sizes<32, 32>>;
+
+                // FNV-1a, used to get keys that are stable between the runs
+                inline std::uint64_t stable_hash(char const *str) {
+                    std::uint64_t res = 14695981039346656037ull;
+                    for (; *str; ++str)
+                        res = (res ^ std::uint64_t(static_cast<unsigned char>(*str))) * 1099511628211ull;
+                    return res;
+                }
+
+                struct tuning_key {
+                    std::uint64_t stencil;
+                    int_t i_size;
+                    int_t j_size;
+                    int_t k_size;
+
+                    friend bool operator<(tuning_key const &lhs, tuning_key const &rhs) {
+                        return std::tie(lhs.stencil, lhs.i_size, lhs.j_size, lhs.k_size) <
+                               std::tie(rhs.stencil, rhs.i_size, rhs.j_size, rhs.k_size);
+                    }
+
+                    friend bool operator==(tuning_key const &lhs, tuning_key const &rhs) {
+                        return std::tie(lhs.stencil, lhs.i_size, lhs.j_size, lhs.k_size) ==
+                               std::tie(rhs.stencil, rhs.i_size, rhs.j_size, rhs.k_size);
+                    }
+                };
+
+                using block_size_pair = std::pair<int_t, int_t>;
+
+                struct tuning_entry {
+                    bool tuned = false;
+                    block_size_pair winner = {0, 0};
+                    std::size_t calls = 0;
+                    std::vector<double> times;
+                };
+
+                /*
+                 *  The tuning state of all stencils, optionally backed by a file.
+                 *
+                 *  File format: one line `<stencil hash> <i size> <j size> <k size> <i block size> <j block size>` per
+                 *  tuned entry, later lines take precedence.
+                 */
+                class tuning_cache {
+                    using winners_t = std::map<tuning_key, block_size_pair>;
+
+                    std::mutex m_mutex;
+                    std::string m_file_name;
+                    std::map<tuning_key, tuning_entry> m_entries;
+
+                    winners_t load() const {
+                        winners_t res;
+                        std::ifstream file(m_file_name);
+                        std::string hash;
+                        tuning_key key;
+                        block_size_pair winner;
+                        while (file >> hash >> key.i_size >> key.j_size >> key.k_size >> winner.first >>
+                               winner.second) {
+                            key.stencil = std::strtoull(hash.c_str(), nullptr, 16);
+                            res[key] = winner;
+                        }
+                        return res;
+                    }
+
+                    // merges the own winners into the ones currently in the file, the file is replaced atomically
+                    void store() const {
+                        auto winners = load();
+                        for (auto const &entry : m_entries)
+                            if (entry.second.tuned)
+                                winners[entry.first] = entry.second.winner;
+                        auto tmp_name = m_file_name + ".tmp" + std::to_string(std::random_device()());
+                        {
+                            std::ofstream file(tmp_name);
+                            for (auto const &winner : winners)
+                                file << std::hex << winner.first.stencil << std::dec << " " << winner.first.i_size
+                                     << " " << winner.first.j_size << " " << winner.first.k_size << " "
+                                     << winner.second.first << " " << winner.second.second << "\n";
+                            if (!file.flush())
+                                return;
+                        }
+                        if (std::rename(tmp_name.c_str(), m_file_name.c_str()))
+                            std::remove(tmp_name.c_str());
+                    }
+
+                  public:
+                    // an empty file name disables the persistence
+                    explicit tuning_cache(std::string file_name = {}) : m_file_name(std::move(file_name)) {
+                        if (m_file_name.empty())
+                            return;
+                        for (auto const &winner : load()) {
+                            auto &entry = m_entries[winner.first];
+                            entry.tuned = true;
+                            entry.winner = winner.second;
+                        }
+                    }
+
+                    // The index of the candidate to use for the next invocation
+                    std::size_t select(tuning_key const &key, std::vector<block_size_pair> const &candidates) {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        auto &entry = m_entries[key];
+                        if (entry.tuned) {
+                            auto found = std::find(candidates.begin(), candidates.end(), entry.winner);
+                            if (found != candidates.end())
+                                return found - candidates.begin();
+                            entry = {};
+                        }
+                        return entry.calls % candidates.size();
+                    }
+
+                    // Records the time of an invocation, picks the winner once all candidates were timed enough
+                    void record(tuning_key const &key,
+                        std::vector<block_size_pair> const &candidates,
+                        std::size_t index,
+                        double seconds,
+                        std::size_t trials) {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        auto &entry = m_entries[key];
+                        if (entry.tuned)
+                            return;
+                        entry.times.resize(candidates.size(), -1);
+                        if (entry.times[index] < 0 || seconds < entry.times[index])
+                            entry.times[index] = seconds;
+                        if (++entry.calls < candidates.size() * trials)
+                            return;
+                        entry.tuned = true;
+                        entry.winner =
+                            candidates[std::min_element(entry.times.begin(), entry.times.end()) - entry.times.begin()];
+                        entry.times.clear();
+                        if (!m_file_name.empty())
+                            store();
+                    }
+
+                    // The winner for the key if it is tuned already
+                    bool winner(tuning_key const &key, block_size_pair &res) {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        auto found = m_entries.find(key);
+                        if (found == m_entries.end() || !found->second.tuned)
+                            return false;
+                        res = found->second.winner;
+                        return true;
+                    }
+                };
+
+                /*
+                 *  The winners of one stencil for one candidate list, as indices into that list. The records form a
+                 *  singly linked list that is scanned without locking from the atomic head. The records are never
+                 *  modified after publishing and never freed before the end of the program, there is one record per
+                 *  tuned domain size.
+                 */
+                class published_winners {
+                    struct record {
+                        tuning_key key;
+                        std::size_t index;
+                        record const *next;
+                    };
+
+                    std::mutex m_mutex;
+                    std::forward_list<record> m_records;
+                    std::atomic<record const *> m_head = {nullptr};
+
+                  public:
+                    bool find(tuning_key const &key, std::size_t &index) const {
+                        for (record const *cur = m_head.load(std::memory_order_acquire); cur; cur = cur->next)
+                            if (cur->key == key) {
+                                index = cur->index;
+                                return true;
+                            }
+                        return false;
+                    }
+
+                    void publish(tuning_key const &key, std::size_t index) {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        record const *head = m_head.load(std::memory_order_relaxed);
+                        for (record const *cur = head; cur; cur = cur->next)
+                            if (cur->key == key)
+                                return;
+                        m_records.push_front({key, index, head});
+                        m_head.store(&m_records.front(), std::memory_order_release);
+                    }
+                };
+
+                inline tuning_cache &global_tuning_cache() {
+                    static tuning_cache res = [] {
+                        char const *env_value = std::getenv("GT_AUTOTUNE_CACHE");
+                        return tuning_cache(env_value ? env_value : "");
+                    }();
+                    return res;
+                }
+
+                template <class Spec, class Grid>
+                tuning_key make_tuning_key(Grid const &grid) {
+                    return {stable_hash(typeid(Spec).name()), grid.i_size(), grid.j_size(), grid.k_size()};
+                }
+
+                template <class BlockSizes>
+                std::vector<block_size_pair> candidates() {
+                    std::vector<block_size_pair> res;
+                    for_each<BlockSizes>([&](auto sizes) {
+                        using sizes_t = decltype(sizes);
+                        res.emplace_back(meta::first<sizes_t>::value, meta::second<sizes_t>::value);
+                    });
+                    return res;
+                }
+
+                template <class BlockSizes, class ThreadPool, class Spec, class Grid, class DataStores>
+                void run_candidate(std::size_t index, Spec spec, Grid const &grid, DataStores data_stores) {
+                    ct_dispatch<meta::length<BlockSizes>::value>(
+                        [&](auto n) {
+                            using sizes_t = meta::at<BlockSizes, decltype(n)>;
+                            using backend_t = cpu_kfirst<meta::first<sizes_t>, meta::second<sizes_t>, ThreadPool>;
+                            gridtools_backend_entry_point(backend_t(), spec, grid, std::move(data_stores));
+                        },
+                        index);
+                }
+
+                template <class BlockSizes = default_block_sizes,
+                    class ThreadPool = thread_pool::omp,
+                    class Trials = integral_constant<int, 3>>
+                struct cpu_kfirst_autotuned {};
+
+                template <class BlockSizes, class ThreadPool, class Trials, class Spec, class Grid, class DataStores>
+                void gridtools_backend_entry_point(cpu_kfirst_autotuned<BlockSizes, ThreadPool, Trials>,
+                    Spec spec,
+                    Grid const &grid,
+                    DataStores data_stores) {
+                    static_assert(meta::length<BlockSizes>::value > 0, "no block sizes to choose from");
+                    static auto const block_size_candidates = candidates<BlockSizes>();
+                    static published_winners published;
+                    auto key = make_tuning_key<Spec>(grid);
+                    std::size_t index;
+                    if (published.find(key, index)) {
+                        run_candidate<BlockSizes, ThreadPool>(index, spec, grid, std::move(data_stores));
+                        return;
+                    }
+                    auto &cache = global_tuning_cache();
+                    index = cache.select(key, block_size_candidates);
+                    auto start = std::chrono::steady_clock::now();
+                    run_candidate<BlockSizes, ThreadPool>(index, spec, grid, std::move(data_stores));
+                    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                    cache.record(key, block_size_candidates, index, elapsed.count(), Trials::value);
+                    block_size_pair winner;
+                    if (cache.winner(key, winner)) {
+                        auto found = std::find(block_size_candidates.begin(), block_size_candidates.end(), winner);
+                        if (found != block_size_candidates.end())
+                            published.publish(key, found - block_size_candidates.begin());
+                    }
+                }
+            } // namespace autotune_impl_
+
+            using autotune_impl_::block_sizes;
+            using autotune_impl_::cpu_kfirst_autotuned;
+            using autotune_impl_::global_tuning_cache;
+            using autotune_impl_::published_winners;
+            using autotune_impl_::tuning_cache;
+            using autotune_impl_::tuning_key;
+        } // namespace cpu_kfirst_backend
+        using cpu_kfirst_backend::block_sizes;
+        using cpu_kfirst_backend::cpu_kfirst_autotuned;
+    } // namespace stencil
+} // namespace gridtools
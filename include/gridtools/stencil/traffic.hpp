@@ -0,0 +1,241 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include "../common/defs.hpp"
+#include "../common/for_each.hpp"
+#include "../common/json_escape.hpp"
+#include "../meta.hpp"
+#include "be_api.hpp"
+#include "common/caches.hpp"
+#include "common/dim.hpp"
+#include "common/instrumentation.hpp"
+#include "cpu_kfirst/k_cache.hpp"
+
+/**
+ *   Static memory traffic analysis of stencils.
+ *
+ *   `traffic<Backend>{sink, stream_bandwidth}` walks `be_api::make_split_view` of the stencil, hence it sees the
+ *   stages after fusion, and estimates the bytes that every stage moves from and to the main memory. If `Backend` is
+ *   not `void`, the stencil is then run with that backend and the measured time is used to report the achieved
+ *   bandwidth, as a fraction of `stream_bandwidth` (in GB/s) if it is given. The bandwidth can be taken from the
+ *   environment variable `GT_STREAM_BANDWIDTH` as well. The report is written to `sink` as JSON.
+ *
+ *   The model assumes an ideal cache within a stage and no reuse between the stages:
+ *     - every field accessed by a stage is read once per computed grid point, and written as well if it is not
+ *       read-only (a written field may be read by the stage too, and the write allocates the cache line anyway), the
+ *       computed points include the extent of the stage;
+ *     - ij-cached placeholders do not generate traffic;
+ *     - k-cached placeholders are read if they are filled and written if they are flushed, as long as a single stage
+ *       accesses them; k-caches shared by several stages are accessed in memory, like in `cpu_kfirst`;
+ *     - temporaries that are not cached are accounted separately, they may or may not stay in the cache depending on
+ *       the backend.
+ *   The compulsory traffic of the stencil counts every non temporary field once over the whole domain, with the same
+ *   read and write model. Both numbers are given in bytes per grid point of the domain.
+ */
+namespace gridtools {
+    namespace stencil {
+        namespace traffic_backend {
+            namespace traffic_impl_ {
+                struct bytes {
+                    double read = 0;
+                    double written = 0;
+                    double tmp = 0;
+
+                    double total() const { return read + written + tmp; }
+
+                    bytes &operator+=(bytes const &other) {
+                        read += other.read;
+                        written += other.written;
+                        tmp += other.tmp;
+                        return *this;
+                    }
+                };
+
+                struct stage_report {
+                    std::string name;
+                    bytes per_point;
+                };
+
+                struct report {
+                    std::string stencil;
+                    int_t i_size;
+                    int_t j_size;
+                    int_t k_size;
+                    std::vector<stage_report> stages;
+                    bytes compulsory;
+
+                    double points() const { return double(i_size) * j_size * k_size; }
+
+                    bytes streamed() const {
+                        bytes res;
+                        for (auto const &stage : stages)
+                            res += stage.per_point;
+                        return res;
+                    }
+                };
+
+                // bytes per computed grid point for one placeholder of a stage
+                template <class Stages, class PlhInfo>
+                bytes plh_bytes(PlhInfo) {
+                    using caches_t = typename PlhInfo::caches_t;
+                    using policies_t = typename PlhInfo::cache_io_policies_t;
+                    double size = sizeof(typename PlhInfo::data_t);
+                    bytes res;
+                    if (meta::st_contains<caches_t, cache_type::ij>::value)
+                        return res;
+                    if (cpu_kfirst_backend::is_local_k_cache_f<Stages>::template apply<PlhInfo>::value) {
+                        if (meta::st_contains<policies_t, cache_io_policy::fill>::value)
+                            res.read = size;
+                        if (meta::st_contains<policies_t, cache_io_policy::flush>::value)
+                            res.written = size;
+                        return res;
+                    }
+                    if (PlhInfo::is_tmp_t::value)
+                        res.tmp = size;
+                    else {
+                        res.read = size;
+                        if (!PlhInfo::is_const_t::value)
+                            res.written = size;
+                    }
+                    return res;
+                }
+
+                template <class Stages, class Stage, class Grid>
+                bytes stage_bytes(Grid const &grid) {
+                    using cells_t = meta::rename<meta::list, decltype(Stage::cells())>;
+                    bytes res;
+                    for_each<meta::transform<meta::lazy::id, cells_t>>([&](auto cell) {
+                        using cell_t = typename decltype(cell)::type;
+                        using extent_t = typename cell_t::extent_t;
+                        double points = double(grid.i_size(extent_t())) * grid.j_size(extent_t()) *
+                                        grid.k_size(cell_t::interval());
+                        for_each<typename cell_t::plh_map_t>([&](auto info) {
+                            bytes cur = plh_bytes<Stages>(info);
+                            res.read += cur.read * points;
+                            res.written += cur.written * points;
+                            res.tmp += cur.tmp * points;
+                        });
+                    });
+                    return res;
+                }
+
+                template <class Spec, class Grid>
+                report make_report(Grid const &grid) {
+                    using stages_t = be_api::make_split_view<Spec>;
+                    char stencil[17];
+                    std::snprintf(stencil, sizeof(stencil), "%016zx", typeid(Spec).hash_code());
+                    report res{stencil, grid.i_size(), grid.j_size(), grid.k_size(stages_t::interval()), {}, {}};
+                    double points = res.points();
+                    for_each<meta::transform<meta::lazy::id, meta::rename<meta::list, stages_t>>>([&](auto stage) {
+                        using stage_t = typename decltype(stage)::type;
+                        bytes cur = stage_bytes<stages_t, stage_t>(grid);
+                        cur.read /= points;
+                        cur.written /= points;
+                        cur.tmp /= points;
+                        res.stages.push_back({instrumentation::stage_name<stage_t>(), cur});
+                    });
+                    for_each<meta::filter<meta::not_<be_api::get_is_tmp>::apply, typename stages_t::plh_map_t>>(
+                        [&](auto info) {
+                            using info_t = decltype(info);
+                            double size = sizeof(typename info_t::data_t);
+                            res.compulsory.read += size;
+                            if (!info_t::is_const_t::value)
+                                res.compulsory.written += size;
+                        });
+                    return res;
+                }
+
+                inline double stream_bandwidth_from_env() {
+                    char const *env_value = std::getenv("GT_STREAM_BANDWIDTH");
+                    return env_value ? std::atof(env_value) : 0;
+                }
+
+                inline void write_bytes(std::ostream &sink, bytes const &src) {
+                    sink << "{\"read\": " << src.read << ", \"written\": " << src.written << ", \"tmp\": " << src.tmp
+                         << ", \"total\": " << src.total() << "}";
+                }
+
+                inline void write_bandwidth(std::ostream &sink, char const *name, double bytes, double seconds,
+                    double stream_bandwidth) {
+                    double bandwidth = bytes / seconds * 1e-9;
+                    sink << ", \"" << name << "_gbps\": " << bandwidth;
+                    if (stream_bandwidth > 0)
+                        sink << ", \"" << name << "_stream_fraction\": " << bandwidth / stream_bandwidth;
+                }
+
+                // `seconds` is negative if the stencil was not run
+                inline void write_json(std::ostream &sink, report const &src, double seconds, double stream_bandwidth) {
+                    sink << "{\"stencil\": \"" << src.stencil << "\", \"domain\": [" << src.i_size << ", "
+                         << src.j_size << ", " << src.k_size << "], \"stages\": [";
+                    for (std::size_t s = 0; s != src.stages.size(); ++s) {
+                        sink << (s ? ",\n" : "\n") << "  {\"stage\": \""
+                             << json_escape(src.stages[s].name)
+                             << "\", \"bytes_per_point\": ";
+                        write_bytes(sink, src.stages[s].per_point);
+                        sink << "}";
+                    }
+                    sink << "\n], \"streamed_bytes_per_point\": ";
+                    write_bytes(sink, src.streamed());
+                    sink << ", \"compulsory_bytes_per_point\": ";
+                    write_bytes(sink, src.compulsory);
+                    if (seconds >= 0) {
+                        sink << ", \"seconds\": " << seconds;
+                        if (seconds > 0) {
+                            write_bandwidth(
+                                sink, "compulsory", src.compulsory.total() * src.points(), seconds, stream_bandwidth);
+                            write_bandwidth(
+                                sink, "streamed", src.streamed().total() * src.points(), seconds, stream_bandwidth);
+                        }
+                    }
+                    if (stream_bandwidth > 0)
+                        sink << ", \"stream_gbps\": " << stream_bandwidth;
+                    sink << "}" << std::endl;
+                }
+
+                template <class Backend = void>
+                struct traffic {
+                    std::ostream &m_sink;
+                    double m_stream_bandwidth = 0;
+
+                    template <class Spec, class Grid, class DataStores>
+                    friend void gridtools_backend_entry_point(
+                        traffic obj, Spec spec, Grid const &grid, DataStores data_stores) {
+                        double seconds = -1;
+                        if constexpr (!std::is_void<Backend>::value) {
+                            auto start = std::chrono::steady_clock::now();
+                            gridtools_backend_entry_point(Backend(), spec, grid, std::move(data_stores));
+                            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                            seconds = elapsed.count();
+                        }
+                        double stream_bandwidth =
+                            obj.m_stream_bandwidth > 0 ? obj.m_stream_bandwidth : stream_bandwidth_from_env();
+                        write_json(obj.m_sink, make_report<Spec>(grid), seconds, stream_bandwidth);
+                    }
+                };
+            } // namespace traffic_impl_
+
+            using traffic_impl_::make_report;
+            using traffic_impl_::report;
+            using traffic_impl_::traffic;
+        } // namespace traffic_backend
+        using traffic_backend::traffic;
+    } // namespace stencil
+} // namespace gridtools
@@ -9,19 +9,24 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <tuple>
 #include <type_traits>
 
 #include "../common/defs.hpp"
 #include "../common/for_each.hpp"
+#include "../common/hugepage_alloc.hpp"
 #include "../common/hymap.hpp"
 #include "../common/integral_constant.hpp"
 #include "../common/layout_map.hpp"
+#include "../common/omp.hpp"
 #include "../common/tuple.hpp"
 #include "../common/tuple_util.hpp"
 #include "../meta.hpp"
 #include "../sid/unknown_kind.hpp"
 #include "data_store.hpp"
+#include "soa.hpp"
 #include "traits.hpp"
 
 namespace gridtools {
@@ -35,6 +40,7 @@ namespace gridtools {
                 struct halos {};
                 struct initializer {};
                 struct layout {};
+                struct soa {};
             } // namespace param
 
             template <class T>
@@ -64,43 +70,219 @@ namespace gridtools {
                 return res;
             }
 
-            template <class Fun, class T, class Layout, class Info, size_t... Is>
-            void initializer_impl(Fun const &fun, T *dst, Layout layout, Info const &info, std::index_sequence<Is...>) {
-                int length = info.length();
-                auto in_range = [&](auto const &indices) {
-                    for (auto ok : {(tuple_util::get<Is>(indices) < tuple_util::get<Is>(info.native_lengths()))...})
-                        if (!ok)
-                            return false;
-                    return true;
+            // The slower of the i and j dimensions in memory, -1 if none of them is in the layout
+            template <class Layout>
+            constexpr int partition_dim() {
+                int res = -1;
+                for (int i = 0; i < 2 && i < int(Layout::masked_length); ++i)
+                    if (Layout::at(i) != -1 && (res == -1 || Layout::at(i) < Layout::at(res)))
+                        res = i;
+                return res;
+            }
+
+            /*
+             *  Calls `f(begin, end)` for disjoint ranges of flat indices that cover [0, info.length()).
+             *
+             *  The backends distribute the horizontal blocks among the threads such that every thread works on a
+             *  contiguous slab along the slower of the i and j dimensions. Here every memory page is processed by the
+             *  thread that owns the first element of the page in that partition. Hence the pages are first touched
+             *  on the NUMA node of the thread that will compute on them.
+             *
+             *  The slab of a thread is periodic in the flat index: it is [pos_begin * stride, pos_end * stride) within
+             *  every period of the stride of the next slower dimension. The padding at the end of a period belongs to
+             *  the last thread. Every thread visits the pages that start within its slab only.
+             */
+            template <class T, class Layout, class Info, class F>
+            void first_touch_for(T *dst, Layout, Info const &info, F const &f) {
+                std::int64_t length = info.length();
+                if (length == 0)
+                    return;
+                constexpr int dim = partition_dim<Layout>();
+                std::int64_t extent = length;
+                std::int64_t stride = 1;
+                std::int64_t period = length;
+                if constexpr (dim != -1) {
+                    extent = info.lengths()[dim];
+                    stride = info.strides()[dim];
+                    if (Layout::at(dim) != 0)
+                        period = info.strides()[Layout::find(Layout::at(dim) - 1)];
+                }
+                std::int64_t page_length = std::max<std::int64_t>(page_size() / sizeof(T), 1);
+                // the pages start at the multiples of `page_length` shifted by `shift` (and at zero)
+                std::int64_t shift = (page_size() - reinterpret_cast<std::uintptr_t>(dst) % page_size()) %
+                                     page_size() / sizeof(T) % page_length;
+                if (shift)
+                    shift = page_length - shift;
+                auto page_start_from = [&](std::int64_t i) {
+                    return i == 0 ? 0 : (i + shift + page_length - 1) / page_length * page_length - shift;
+                };
+                auto page_end = [&](std::int64_t i) {
+                    return std::min((i + shift) / page_length * page_length + page_length - shift, length);
                 };
 #ifdef _OPENMP
-#pragma omp parallel for
+#pragma omp parallel
 #endif
-                for (int i = 0; i < length; ++i) {
-                    auto indices = restore_indices(info, layout, i);
-                    if (in_range(indices))
-                        dst[i] = fun(tuple_util::get<Is>(indices)...);
+                {
+                    std::int64_t threads = omp_get_num_threads();
+                    std::int64_t thread = omp_get_thread_num();
+                    std::int64_t slab_begin = (thread * extent + threads - 1) / threads * stride;
+                    std::int64_t slab_end = ((thread + 1) * extent + threads - 1) / threads * stride;
+                    if (thread == threads - 1)
+                        slab_end = period;
+                    for (std::int64_t offset = 0; offset < length; offset += period) {
+                        std::int64_t end = std::min(offset + slab_end, length);
+                        for (std::int64_t i = page_start_from(offset + slab_begin); i < end; i = page_end(i))
+                            f(int(i), int(page_end(i)));
+                    }
                 }
             }
 
+            /*
+             *  Calls `assign(ptr, indices...)` for the elements of the storage. The elements of [begin, end) are
+             *  visited in the memory order: the indices are restored once and then advanced incrementally, the padding
+             *  at the end of the innermost rows is skipped.
+             */
+            template <class Assign, class T, class Layout, class Info, size_t... Is>
+            void initializer_impl(
+                Assign const &assign, T *dst, Layout layout, Info const &info, std::index_sequence<Is...>) {
+                first_touch_for(dst, layout, info, [&](int begin, int end) {
+                    if constexpr (Layout::unmasked_length == 0) {
+                        for (int i = begin; i < end; ++i) {
+                            auto indices = restore_indices(info, layout, i);
+                            assign(dst + i, indices[Is]...);
+                        }
+                    } else {
+                        constexpr int inner = Layout::find(Layout::max_arg);
+                        auto lengths = info.lengths();
+                        // the innermost rows are padded up to the stride of the next dimension
+                        int row_length =
+                            Layout::max_arg == 0 ? info.length() : info.strides()[Layout::find(Layout::max_arg - 1)];
+                        auto indices = restore_indices(info, layout, begin);
+                        for (int i = begin; i < end;) {
+                            int row_begin = indices[inner];
+                            int n = std::min(end - i, row_length - row_begin);
+                            int row_end = row_begin + std::clamp(int(lengths[inner]) - row_begin, 0, n);
+                            T *row = dst + i - row_begin;
+                            for (int x = row_begin; x < row_end; ++x)
+                                assign(row + x, (int(Is) == inner ? x : indices[Is])...);
+                            i += n;
+                            indices[inner] = 0;
+                            for (int arg = Layout::max_arg - 1; arg >= 0; --arg) {
+                                int dim = Layout::find(arg);
+                                if (++indices[dim] < int(lengths[dim]))
+                                    break;
+                                indices[dim] = 0;
+                            }
+                        }
+                    }
+                });
+            }
+
             template <class Fun>
-            auto wrap_initializer(Fun fun) {
-                return [fun = std::move(fun)](auto *dst, auto layout, auto const &info) {
-                    initializer_impl(
-                        fun, dst, layout, info, std::make_index_sequence<std::decay_t<decltype(info)>::ndims>());
-                };
+            struct initializer_f {
+                Fun m_fun;
+
+                template <class T, class Layout, class Info>
+                void operator()(T *dst, Layout layout, Info const &info) const {
+                    initializer_impl([this](T *ptr, auto... indices) { *ptr = m_fun(indices...); },
+                        dst,
+                        layout,
+                        info,
+                        std::make_index_sequence<Info::ndims>());
+                }
+            };
+
+            template <class Fun>
+            initializer_f<Fun> wrap_initializer(Fun fun) {
+                return {std::move(fun)};
             }
 
+            template <class Value>
+            struct value_f {
+                Value m_value;
+
+                template <class T, class Layout, class Info>
+                void operator()(T *dst, Layout layout, Info const &info) const {
+                    first_touch_for(dst, layout, info, [&](int begin, int end) {
+                        for (int i = begin; i < end; ++i)
+                            dst[i] = m_value;
+                    });
+                }
+            };
+
             template <class T>
-            auto wrap_value(T const &value) {
-                return [value = std::move(value)](auto *dst, auto, auto const &info) {
-                    int length = info.length();
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-                    for (int i = 0; i < length; ++i)
-                        dst[i] = value;
-                };
+            value_f<T> wrap_value(T const &value) {
+                return {value};
+            }
+
+            // The first plane of a structure of arrays storage, the component dimension is the last one
+            template <size_t N>
+            struct plane_info {
+                static constexpr size_t ndims = N;
+
+                array<uint_t, N> m_lengths;
+                array<uint_t, N> m_strides;
+                int m_length;
+
+                array<uint_t, N> const &lengths() const { return m_lengths; }
+                array<uint_t, N> const &strides() const { return m_strides; }
+                int length() const { return m_length; }
+            };
+
+            /*
+             *  Initializer of the planes of a structure of arrays storage. The field initializer is called once per
+             *  point of the first plane, the components of the result are scattered to all the planes.
+             */
+            template <class FieldLayout, class Fun>
+            struct soa_initializer_f {
+                Fun m_fun;
+
+                template <class T, class Layout, class Info>
+                void operator()(T *dst, Layout, Info const &info) const {
+                    constexpr size_t n = Info::ndims - 1;
+                    auto lengths = info.lengths();
+                    auto strides = info.strides();
+                    int plane_stride = strides[n];
+                    plane_info<n> plane;
+                    for (size_t i = 0; i != n; ++i) {
+                        plane.m_lengths[i] = lengths[i];
+                        plane.m_strides[i] = strides[i];
+                    }
+                    plane.m_length = info.length() == 0 ? 0 : info.length() - (int(lengths[n]) - 1) * plane_stride;
+                    initializer_impl(
+                        [this, plane_stride](T *ptr, auto... indices) {
+                            int component = 0;
+                            tuple_util::for_each(
+                                [&](auto const &elem) { ptr[component++ * plane_stride] = elem; },
+                                m_fun(indices...));
+                        },
+                        dst,
+                        FieldLayout(),
+                        plane,
+                        std::make_index_sequence<n>());
+                }
+            };
+
+            template <class FieldLayout>
+            uninitialized soa_initializer(uninitialized) {
+                return {};
+            }
+
+            template <class FieldLayout, class Fun>
+            soa_initializer_f<FieldLayout, Fun> soa_initializer(initializer_f<Fun> const &init) {
+                return {init.m_fun};
+            }
+
+            template <class FieldLayout, class Value>
+            auto soa_initializer(value_f<Value> const &init) {
+                auto fun = [value = init.m_value](auto...) { return value; };
+                return soa_initializer<FieldLayout>(wrap_initializer(std::move(fun)));
+            }
+
+            // The component dimension goes first in the layout, each component is a contiguous plane
+            template <int... Args>
+            layout_map<(Args < 0 ? Args : Args + 1)..., 0> soa_layout(layout_map<Args...>) {
+                return {};
             }
 
             template <class Traits, class Layout>
@@ -264,6 +446,12 @@ namespace gridtools {
                     return add_type<param::layout, layout_t>();
                 }
 
+                // Tuple-valued elements are stored as structure of arrays, `build()` then returns a soa_data_store
+                auto soa() const {
+                    static_assert(!has<param::soa>::value, "storage soa is set twice");
+                    return add_type<param::soa, std::true_type>();
+                }
+
                 auto name(std::string value) const {
                     static_assert(!has<param::name>::value, "storage name is set twice");
                     return add_value<param::name>(std::move(value));
@@ -303,6 +491,42 @@ namespace gridtools {
                 auto build() const {
                     static_assert(has<param::type>::value, "storage type is not set");
                     static_assert(has<param::lengths>::value, "storage lengths are not set");
+                    if constexpr (has<param::soa>::value)
+                        return build_soa();
+                    else
+                        return build_aos();
+                }
+
+                auto operator()() const { return build(); }
+
+              private:
+                auto build_soa() const {
+                    using type_t = typename value_type<param::type>::type;
+                    using types_t = tuple_util::traits::to_types<std::remove_const_t<type_t>>;
+                    static_assert(meta::length<types_t>::value > 0, "soa storage type should be a non empty tuple");
+                    static_assert(meta::all_are_same<types_t>::value, "soa storage type should be a homogeneous tuple");
+                    using component_t = meta::first<types_t>;
+                    using elem_t = std::conditional_t<std::is_const_v<type_t>, component_t const, component_t>;
+                    constexpr auto n = tuple_util::size<value_type<param::lengths>>::value;
+                    using default_layout_t = traits::layout_type<Traits, n>;
+                    using field_layout_t =
+                        meta::if_c<has<param::layout>::value, value_type<param::layout>, default_layout_t>;
+                    using layout_t = decltype(soa_layout(field_layout_t()));
+                    using num_components_t = integral_constant<int_t, meta::length<types_t>::value>;
+                    auto &&halos = value<param::halos, array<int, n>>();
+                    array<int, n + 1> soa_halos;
+                    for (size_t i = 0; i != n; ++i)
+                        soa_halos[i] = halos[i];
+                    soa_halos[n] = 0;
+                    auto planes = make_data_store<custom_traits<Traits, layout_t>, elem_t, value_type<param::id>>(
+                        value<param::name, std::string>(),
+                        tuple_util::deep_copy(tuple_util::push_back(value<param::lengths>(), num_components_t())),
+                        soa_halos,
+                        soa_initializer<field_layout_t>(value<param::initializer, uninitialized>()));
+                    return make_soa_data_store<type_t>(std::move(planes));
+                }
+
+                auto build_aos() const {
                     using traits_t =
                         meta::if_c<has<param::layout>::value, custom_traits<Traits, value_type<param::layout>>, Traits>;
                     auto &&lengths = value<param::lengths>();
@@ -313,8 +537,6 @@ namespace gridtools {
                     return make_data_store<traits_t, typename value_type<param::type>::type, value_type<param::id>>(
                         name, lengths, halos, initializer);
                 }
-
-                auto operator()() const { return build(); }
             };
             template <class Traits>
             constexpr builder_type<Traits, keys<>::values<>> builder = {};
@@ -0,0 +1,153 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "../common/array.hpp"
+#include "../common/defs.hpp"
+#include "../common/host_device.hpp"
+#include "../common/hymap.hpp"
+#include "../common/integral_constant.hpp"
+#include "../common/tuple.hpp"
+#include "../common/tuple_util.hpp"
+#include "../meta.hpp"
+#include "../sid/concept.hpp"
+#include "../sid/unknown_kind.hpp"
+#include "data_store.hpp"
+#include "sid.hpp"
+
+/**
+ *   Structure of arrays storage for tuple-valued fields.
+ *
+ *   `soa_data_store<T, DataStorePtr>` stores the elements of the tuple-like type `T` in separate contiguous planes.
+ *   The planes are held by a regular data store of the element type that has one extra (outermost) dimension, the
+ *   component index. All elements of `T` have to be of the same type.
+ *
+ *   Like `data_store`, `soa_data_store` is held by a `std::shared_ptr` and the shared pointer models SID with the
+ *   dimensions of the field. Dereferencing its pointers gives a tuple of references to the components, hence reading
+ *   yields a tuple-like value and assigning a tuple scatters the components into the planes.
+ *
+ *   Host access goes through the planes: `planes()->host_view()(i, j, ..., component)`.
+ *
+ *   Typically created by `storage::builder<Traits>.type<T>().soa()...build()`.
+ */
+namespace gridtools {
+    namespace storage {
+        namespace soa_impl_ {
+            template <size_t, class T>
+            using ref_t = T &;
+
+            template <class T, size_t N>
+            struct soa_ptr {
+                T *m_ptr;
+                int_t m_plane_stride;
+
+                template <size_t... Is>
+                GT_FUNCTION tuple<ref_t<Is, T>...> deref(std::index_sequence<Is...>) const {
+                    return {m_ptr[Is * m_plane_stride]...};
+                }
+
+                GT_FUNCTION auto operator*() const { return deref(std::make_index_sequence<N>()); }
+
+                GT_FUNCTION soa_ptr &operator+=(int_t offset) {
+                    m_ptr += offset;
+                    return *this;
+                }
+
+                friend GT_FUNCTION soa_ptr operator+(soa_ptr obj, int_t offset) { return obj += offset; }
+            };
+
+            template <class T, size_t N>
+            struct soa_ptr_holder {
+                soa_ptr<T, N> m_ptr;
+
+                GT_FUNCTION constexpr soa_ptr<T, N> operator()() const { return m_ptr; }
+
+                friend GT_FORCE_INLINE constexpr soa_ptr_holder operator+(soa_ptr_holder obj, int_t offset) {
+                    obj.m_ptr += offset;
+                    return obj;
+                }
+            };
+
+            template <class Kind>
+            struct soa_kind {};
+
+            template <class T, class DataStorePtr>
+            class soa_data_store {
+                using data_store_t = typename DataStorePtr::element_type;
+
+                DataStorePtr m_planes;
+
+              public:
+                using data_t = T;
+                using component_dim_t = integral_constant<int, data_store_t::ndims - 1>;
+                using kind_t = meta::if_<std::is_same<typename data_store_t::kind_t, sid::unknown_kind>,
+                    sid::unknown_kind,
+                    soa_kind<typename data_store_t::kind_t>>;
+                static constexpr size_t ndims = data_store_t::ndims - 1;
+                static constexpr size_t num_components = tuple_util::size<std::remove_const_t<T>>::value;
+
+                explicit soa_data_store(DataStorePtr planes) : m_planes(std::move(planes)) {}
+
+                DataStorePtr const &planes() const { return m_planes; }
+                auto const &name() const { return m_planes->name(); }
+
+                array<uint_t, ndims> lengths() const {
+                    array<uint_t, ndims> res;
+                    for (size_t i = 0; i != ndims; ++i)
+                        res[i] = m_planes->lengths()[i];
+                    return res;
+                }
+
+                // the functions below make `std::shared_ptr<soa_data_store>` model the `SID` concept
+
+                friend auto sid_get_origin(std::shared_ptr<soa_data_store> const &obj) {
+                    using elem_t = std::remove_pointer_t<decltype(obj->m_planes->get_target_ptr())>;
+                    int_t plane_stride = obj->m_planes->strides()[ndims];
+                    return soa_ptr_holder<elem_t, num_components>{{obj->m_planes->get_target_ptr(), plane_stride}};
+                }
+
+                friend auto sid_get_strides(std::shared_ptr<soa_data_store> const &obj) {
+                    return hymap::canonicalize_and_remove_key<component_dim_t>(sid::get_strides(obj->m_planes));
+                }
+
+                friend kind_t sid_get_strides_kind(std::shared_ptr<soa_data_store> const &) { return {}; }
+
+                friend int_t sid_get_ptr_diff(std::shared_ptr<soa_data_store> const &) { return 0; }
+
+                friend auto sid_get_lower_bounds(std::shared_ptr<soa_data_store> const &obj) {
+                    return hymap::canonicalize_and_remove_key<component_dim_t>(sid::get_lower_bounds(obj->m_planes));
+                }
+
+                friend auto sid_get_upper_bounds(std::shared_ptr<soa_data_store> const &obj) {
+                    return hymap::canonicalize_and_remove_key<component_dim_t>(sid::get_upper_bounds(obj->m_planes));
+                }
+            };
+
+            template <class T, class DataStorePtr>
+            std::shared_ptr<soa_data_store<T, DataStorePtr>> make_soa_data_store(DataStorePtr planes) {
+                return std::make_shared<soa_data_store<T, DataStorePtr>>(std::move(planes));
+            }
+
+            template <class>
+            struct is_soa_data_store : std::false_type {};
+
+            template <class T, class DataStorePtr>
+            struct is_soa_data_store<soa_data_store<T, DataStorePtr>> : std::true_type {};
+        } // namespace soa_impl_
+
+        using soa_impl_::is_soa_data_store;
+        using soa_impl_::make_soa_data_store;
+        using soa_impl_::soa_data_store;
+    } // namespace storage
+} // namespace gridtools
@@ -0,0 +1,277 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "../common/defs.hpp"
+
+/**
+ *   A thread pool built on `std::thread` that does not depend on OpenMP.
+ *
+ *   The workers are persistent and pinned to the cores the process is allowed to run on. The calling thread takes part
+ *   in the loops as the worker number zero. The iteration space of a `parallel_for_loop` is cut into chunks, every
+ *   worker gets a contiguous range of them in its own deque. Workers that run out of chunks steal from the back of the
+ *   deques of the others.
+ *
+ *   The number of workers defaults to the number of cores available to the process, it can be overridden with the
+ *   environment variable `GT_NUM_THREADS`. Nested loops are executed serially by the calling worker. The pool is
+ *   shared by the process, loops that are started concurrently from several threads are executed one after another.
+ */
+namespace gridtools {
+    namespace thread_pool {
+        namespace work_stealing_impl_ {
+            // chunks per worker, more chunks give better load balance at higher scheduling cost
+            constexpr int_t chunks_per_worker = 8;
+
+            struct chunk {
+                int_t begin;
+                int_t end;
+            };
+
+            inline std::vector<int> available_cpus() {
+                std::vector<int> res;
+#ifdef __linux__
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                if (sched_getaffinity(0, sizeof(set), &set) == 0)
+                    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                        if (CPU_ISSET(cpu, &set))
+                            res.push_back(cpu);
+#endif
+                return res;
+            }
+
+            inline void pin_current_thread(int cpu) {
+#ifdef __linux__
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpu, &set);
+                pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+            }
+
+            inline int num_threads_from_env(int default_value) {
+                char const *env_value = std::getenv("GT_NUM_THREADS");
+                int res = env_value ? std::atoi(env_value) : 0;
+                return res > 0 ? res : default_value;
+            }
+
+            class pool {
+                struct alignas(64) queue {
+                    std::mutex m_mutex;
+                    std::deque<chunk> m_chunks;
+                };
+
+                using fun_t = void (*)(void const *, int_t, int_t);
+
+                int m_size;
+                std::unique_ptr<queue[]> m_queues;
+                std::vector<std::thread> m_threads;
+
+                // serializes the loops started by the threads outside of the pool
+                std::mutex m_caller_mutex;
+                std::mutex m_mutex;
+                std::condition_variable m_start;
+                std::condition_variable m_done;
+                std::size_t m_generation = 0;
+                int m_busy = 0;
+                bool m_stop = false;
+                fun_t m_fun = nullptr;
+                void const *m_context = nullptr;
+
+                static int &thread_num_impl() {
+                    static thread_local int res = 0;
+                    return res;
+                }
+
+                static bool &in_loop() {
+                    static thread_local bool res = false;
+                    return res;
+                }
+
+                bool pop(int worker, chunk &res) {
+                    auto &q = m_queues[worker];
+                    std::lock_guard<std::mutex> lock(q.m_mutex);
+                    if (q.m_chunks.empty())
+                        return false;
+                    res = q.m_chunks.front();
+                    q.m_chunks.pop_front();
+                    return true;
+                }
+
+                bool steal(int worker, chunk &res) {
+                    for (int i = 1; i < m_size; ++i) {
+                        auto &q = m_queues[(worker + i) % m_size];
+                        std::lock_guard<std::mutex> lock(q.m_mutex);
+                        if (q.m_chunks.empty())
+                            continue;
+                        res = q.m_chunks.back();
+                        q.m_chunks.pop_back();
+                        return true;
+                    }
+                    return false;
+                }
+
+                void work(int worker) {
+                    in_loop() = true;
+                    chunk c;
+                    while (pop(worker, c) || steal(worker, c))
+                        m_fun(m_context, c.begin, c.end);
+                    in_loop() = false;
+                }
+
+                void worker_loop(int worker, int cpu) {
+                    thread_num_impl() = worker;
+                    if (cpu >= 0)
+                        pin_current_thread(cpu);
+                    std::size_t generation = 0;
+                    while (true) {
+                        {
+                            std::unique_lock<std::mutex> lock(m_mutex);
+                            m_start.wait(lock, [&] { return m_stop || m_generation != generation; });
+                            if (m_stop)
+                                return;
+                            generation = m_generation;
+                        }
+                        work(worker);
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        if (--m_busy == 0)
+                            m_done.notify_one();
+                    }
+                }
+
+                template <class F>
+                static void call_chunk(void const *context, int_t begin, int_t end) {
+                    auto const &f = *static_cast<F const *>(context);
+                    for (int_t i = begin; i < end; ++i)
+                        f(i);
+                }
+
+              public:
+                explicit pool(int size) : m_size(std::max(size, 1)), m_queues(new queue[m_size]) {
+                    auto cpus = available_cpus();
+                    for (int worker = 1; worker < m_size; ++worker)
+                        m_threads.emplace_back(&pool::worker_loop,
+                            this,
+                            worker,
+                            cpus.empty() ? -1 : cpus[worker % cpus.size()]);
+                }
+
+                pool(pool const &) = delete;
+                pool &operator=(pool const &) = delete;
+
+                ~pool() {
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_stop = true;
+                    }
+                    m_start.notify_all();
+                    for (auto &thread : m_threads)
+                        thread.join();
+                }
+
+                int size() const { return m_size; }
+
+                static int thread_num() { return thread_num_impl(); }
+
+                // calls `f(i)` for all `i` in [0, size)
+                template <class F>
+                void parallel_for(F const &f, int_t size) {
+                    if (size <= 0)
+                        return;
+                    if (m_size == 1 || in_loop()) {
+                        for (int_t i = 0; i < size; ++i)
+                            f(i);
+                        return;
+                    }
+
+                    std::lock_guard<std::mutex> caller_lock(m_caller_mutex);
+
+                    // the workers are idle here, hence the queues can be filled without contention
+                    int_t chunk_size = std::max<int_t>(size / (m_size * chunks_per_worker), 1);
+                    int_t num_chunks = (size + chunk_size - 1) / chunk_size;
+                    for (int worker = 0; worker < m_size; ++worker) {
+                        auto &q = m_queues[worker];
+                        std::lock_guard<std::mutex> lock(q.m_mutex);
+                        for (int_t c = num_chunks * worker / m_size; c < num_chunks * (worker + 1) / m_size; ++c)
+                            q.m_chunks.push_back({c * chunk_size, std::min((c + 1) * chunk_size, size)});
+                    }
+
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_fun = &call_chunk<F>;
+                        m_context = &f;
+                        m_busy = m_size - 1;
+                        ++m_generation;
+                    }
+                    m_start.notify_all();
+
+                    int caller_thread_num = thread_num_impl();
+                    thread_num_impl() = 0;
+                    work(0);
+                    thread_num_impl() = caller_thread_num;
+
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_done.wait(lock, [&] { return m_busy == 0; });
+                }
+            };
+
+            inline pool &instance() {
+                static pool res(num_threads_from_env(
+                    std::max<int>(available_cpus().size(), std::max<int>(std::thread::hardware_concurrency(), 1))));
+                return res;
+            }
+
+            struct work_stealing {
+                friend int thread_pool_get_thread_num(work_stealing) { return pool::thread_num(); }
+                friend int thread_pool_get_max_threads(work_stealing) { return instance().size(); }
+
+                template <class F, class I>
+                friend void thread_pool_parallel_for_loop(work_stealing, F const &f, I lim) {
+                    instance().parallel_for([&](int_t index) { f(I(index)); }, lim);
+                }
+
+                template <class F, class I, class J>
+                friend void thread_pool_parallel_for_loop(work_stealing, F const &f, I i_lim, J j_lim) {
+                    int_t i_size = i_lim;
+                    instance().parallel_for(
+                        [&](int_t index) { f(I(index % i_size), J(index / i_size)); }, i_size * j_lim);
+                }
+
+                template <class F, class I, class J, class K>
+                friend void thread_pool_parallel_for_loop(work_stealing, F const &f, I i_lim, J j_lim, K k_lim) {
+                    int_t i_size = i_lim;
+                    int_t ij_size = i_size * j_lim;
+                    instance().parallel_for(
+                        [&](int_t index) {
+                            f(I(index % i_size), J(index % ij_size / i_size), K(index / ij_size));
+                        },
+                        ij_size * k_lim);
+                }
+            };
+        } // namespace work_stealing_impl_
+
+        using work_stealing_impl_::work_stealing;
+    } // namespace thread_pool
+} // namespace gridtools
@@ -10,6 +10,8 @@
 #pragma once
 
 #include <cassert>
+#include <utility>
+#include <vector>
 
 #include <gridtools/storage/builder.hpp>
 #include <type_traits>
@@ -107,10 +109,33 @@ namespace gridtools {
             return make_storage<T const>(std::forward<Args>(args)...);
         }
 
+        // tuple-valued storage with the components in separate planes
+        template <class T, class Init, class... Dims>
+        auto make_soa_storage(Init const &init, Dims... dims) const {
+            return storage::builder<StorageTraits>.dimensions(dims...).template type<T>().soa().initializer(init).unknown_id().build();
+        }
+
         auto v2e_table() const {
             return storage::builder<StorageTraits>.dimensions(nvertices()).template type<array<int, max_v2e_neighbors_t::value>>().initializer(v2e_initializer()).unknown_id().build();
         }
 
+        // v2e in compressed sparse row format: storages of offsets and indices
+        auto v2e_csr_tables() const {
+            std::vector<int> offsets = {0}, indices;
+            auto neighbors = v2e_initializer();
+            for (int vertex = 0; vertex < nvertices(); ++vertex) {
+                auto ns = neighbors(vertex);
+                for (int i = 0; i < max_v2e_neighbors_t::value; ++i)
+                    if (ns[i] != -1)
+                        indices.push_back(ns[i]);
+                offsets.push_back(indices.size());
+            }
+            auto make_table = [](std::vector<int> const &values) {
+                return storage::builder<StorageTraits>.dimensions(values.size()).template type<int>().initializer([&](int i) { return values[i]; }).unknown_id().build();
+            };
+            return std::pair(make_table(offsets), make_table(indices));
+        }
+
         auto e2v_table() const {
             return storage::builder<StorageTraits>.dimensions(nedges()).template type<array<int, max_e2v_neighbors_t::value>>().initializer(e2v_initializer()).unknown_id().build();
         }
@@ -28,6 +28,28 @@
 namespace {
     using fn_backend_t = gridtools::fn::backend::naive;
 }
+#elif defined(GT_FN_CPU)
+#ifndef GT_STENCIL_CPU_KFIRST
+#define GT_STENCIL_CPU_KFIRST
+#endif
+#ifndef GT_STORAGE_CPU_KFIRST
+#define GT_STORAGE_CPU_KFIRST
+#endif
+#ifndef GT_TIMER_OMP
+#define GT_TIMER_OMP
+#endif
+#include <gridtools/fn/backend/cpu.hpp>
+namespace {
+    template <int... sizes>
+    using block_sizes_t =
+        gridtools::meta::zip<gridtools::meta::iseq_to_list<std::make_integer_sequence<int, sizeof...(sizes)>,
+                                 gridtools::meta::list,
+                                 gridtools::integral_constant>,
+            gridtools::meta::list<gridtools::integral_constant<int, sizes>...>>;
+
+    using fn_backend_t = gridtools::fn::backend::
+        cpu<block_sizes_t<8, 8>, gridtools::thread_pool::omp, gridtools::integral_constant<int, 4>>;
+} // namespace
 #elif defined(GT_FN_GPU)
 #ifndef GT_STENCIL_GPU
 #define GT_STENCIL_GPU
@@ -63,6 +85,19 @@ namespace gridtools::fn::backend {
         inline char const *backend_name(naive const &) { return "naive"; }
     } // namespace naive_impl_
 
+    namespace cpu_impl_ {
+        template <class, class, class>
+        struct cpu;
+        template <class BlockSizes, class ThreadPool, class ColumnWidth>
+        storage::cpu_kfirst backend_storage_traits(cpu<BlockSizes, ThreadPool, ColumnWidth>);
+        template <class BlockSizes, class ThreadPool, class ColumnWidth>
+        timer_omp backend_timer_impl(cpu<BlockSizes, ThreadPool, ColumnWidth>);
+        template <class BlockSizes, class ThreadPool, class ColumnWidth>
+        inline char const *backend_name(cpu<BlockSizes, ThreadPool, ColumnWidth> const &) {
+            return "cpu";
+        }
+    } // namespace cpu_impl_
+
     namespace gpu_impl_ {
         template <class>
         struct gpu;
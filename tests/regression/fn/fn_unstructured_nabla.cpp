@@ -10,6 +10,7 @@
 
 #include <gtest/gtest.h>
 
+#include <gridtools/fn/csr_neighbor_table.hpp>
 #include <gridtools/fn/unstructured.hpp>
 
 #include <fn_select.hpp>
@@ -59,6 +60,16 @@ namespace {
         }
     };
 
+    struct nabla_stencil_csr {
+        constexpr auto operator()() const {
+            return [](auto const &zavg, auto const &sign, auto const &vol) {
+                auto tmp = sum_over(zavg, v2e(), deref(sign));
+                auto v = deref(vol);
+                return make_tuple(tuple_get(0_c, tmp) / v, tuple_get(1_c, tmp) / v);
+            };
+        }
+    };
+
     struct nabla_stencil_fused {
         constexpr auto operator()() const {
             return [](auto const &sign, auto const &vol, auto const &pp, auto const &s) {
@@ -129,6 +140,16 @@ namespace {
         [](auto executor, auto &nabla, auto const &zavg, auto const &sign, auto const &vol) {
             executor().arg(nabla).arg(zavg).arg(sign).arg(vol).assign(0_c, nabla_stencil(), 1_c, 2_c, 3_c).execute();
         };
+    constexpr inline auto apply_nabla_csr =
+        [](auto executor, auto &nabla, auto const &zavg, auto const &sign, auto const &vol) {
+            executor()
+                .arg(nabla)
+                .arg(zavg)
+                .arg(sign)
+                .arg(vol)
+                .assign(0_c, nabla_stencil_csr(), 1_c, 2_c, 3_c)
+                .execute();
+        };
     constexpr inline auto apply_nabla_fused =
         [](auto executor, auto &nabla, auto const &sign, auto const &vol, auto const &pp, auto const &s) {
             executor()
@@ -165,6 +186,31 @@ namespace {
         apply_nabla(vertex_backend.stencil_executor(), nabla, zavg, sign, vol);
     };
 
+    constexpr inline auto fencil_csr = [](auto backend,
+                                           int nvertices,
+                                           int nedges,
+                                           int nlevels,
+                                           auto const &v2e_offsets,
+                                           auto const &v2e_indices,
+                                           auto const &e2v_table,
+                                           auto &nabla,
+                                           auto const &pp,
+                                           auto const &s,
+                                           auto const &sign,
+                                           auto const &vol) {
+        using float_t = std::remove_const_t<sid::element_type<decltype(pp)>>;
+        auto v2e_conn = connectivity<v2e>(make_csr_neighbor_table<6>(v2e_offsets, v2e_indices));
+        auto e2v_conn = connectivity<e2v>(neighbor_table::dense(e2v_table));
+        auto edge_domain = unstructured_domain({nedges, nlevels}, {}, e2v_conn);
+        auto vertex_domain = unstructured_domain({nvertices, nlevels}, {}, v2e_conn);
+        auto edge_backend = make_backend(backend, edge_domain);
+        auto vertex_backend = make_backend(backend, vertex_domain);
+        auto alloc = tmp_allocator(backend);
+        auto zavg = allocate_global_tmp<tuple<float_t, float_t>>(alloc, edge_domain.sizes());
+        apply_zavg(edge_backend.stencil_executor(), zavg, pp, s);
+        apply_nabla_csr(vertex_backend.stencil_executor(), nabla, zavg, sign, vol);
+    };
+
     constexpr inline auto fencil_fused = [](auto backend,
                                              int nvertices,
                                              int nlevels,
@@ -176,7 +222,7 @@ namespace {
                                              auto const &sign,
                                              auto const &vol) {
         auto v2e_conn = connectivity<v2e>(v2e_table);
-        auto e2v_conn = connectivity<e2v>(e2v_table);
+        auto e2v_conn = connectivity<e2v>(neighbor_table::dense(e2v_table));
         auto vertex_domain = unstructured_domain({nvertices, nlevels}, {}, v2e_conn, e2v_conn);
         auto vertex_backend = make_backend(backend, vertex_domain);
         apply_nabla_fused(vertex_backend.stencil_executor(), nabla, sign, vol, pp, s);
@@ -200,6 +246,55 @@ namespace {
         };
     };
 
+    constexpr inline auto make_comp_soa = [](auto backend, auto const &mesh, auto &nabla) {
+        return [backend,
+                   &nabla,
+                   nvertices = mesh.nvertices(),
+                   nedges = mesh.nedges(),
+                   nlevels = mesh.nlevels(),
+                   v2e_table = mesh.v2e_table(),
+                   e2v_table = mesh.e2v_table(),
+                   pp = mesh.make_const_storage(pp, mesh.nvertices(), mesh.nlevels()),
+                   sign = mesh.template make_const_storage<array<float_t, 6>>(sign, mesh.nvertices()),
+                   vol = mesh.make_const_storage(vol, mesh.nvertices()),
+                   s = mesh.template make_soa_storage<tuple<float_t, float_t> const>(
+                       s, mesh.nedges(), mesh.nlevels())] {
+            auto v2e_ptr = v2e_table->get_const_target_ptr();
+            auto e2v_ptr = e2v_table->get_const_target_ptr();
+            fencil(backend, nvertices, nedges, nlevels, v2e_ptr, e2v_ptr, nabla, pp, s, sign, vol);
+        };
+    };
+
+    constexpr inline auto make_comp_csr = [](auto backend, auto const &mesh, auto &nabla) {
+        return [backend,
+                   &nabla,
+                   nvertices = mesh.nvertices(),
+                   nedges = mesh.nedges(),
+                   nlevels = mesh.nlevels(),
+                   v2e_tables = mesh.v2e_csr_tables(),
+                   e2v_table = mesh.e2v_table(),
+                   pp = mesh.make_const_storage(pp, mesh.nvertices(), mesh.nlevels()),
+                   sign = mesh.template make_const_storage<array<float_t, 6>>(sign, mesh.nvertices()),
+                   vol = mesh.make_const_storage(vol, mesh.nvertices()),
+                   s = mesh.template make_const_storage<tuple<float_t, float_t>>(s, mesh.nedges(), mesh.nlevels())] {
+            auto v2e_offsets_ptr = v2e_tables.first->get_const_target_ptr();
+            auto v2e_indices_ptr = v2e_tables.second->get_const_target_ptr();
+            auto e2v_ptr = e2v_table->get_const_target_ptr();
+            fencil_csr(backend,
+                nvertices,
+                nedges,
+                nlevels,
+                v2e_offsets_ptr,
+                v2e_indices_ptr,
+                e2v_ptr,
+                nabla,
+                pp,
+                s,
+                sign,
+                vol);
+        };
+    };
+
     constexpr inline auto make_comp_fused = [](auto backend, auto const &mesh, auto &nabla) {
         return [backend,
                    &nabla,
@@ -237,6 +332,36 @@ namespace {
         TypeParam::benchmark("fn_unstructured_nabla_field_of_tuples", comp);
     }
 
+    GT_REGRESSION_TEST(fn_unstructured_nabla_soa_field_of_tuples, test_environment<>, fn_backend_t) {
+        using float_t = typename TypeParam::float_t;
+
+        auto mesh = TypeParam::fn_unstructured_mesh();
+        auto nabla = mesh.template make_soa_storage<tuple<float_t, float_t>>(
+            [](int, int) { return tuple<float_t, float_t>(); }, mesh.nvertices(), mesh.nlevels());
+        auto comp = make_comp_soa(fn_backend_t(), mesh, nabla);
+        comp();
+        auto expected = make_expected(mesh);
+        TypeParam::verify(
+            [&](int vertex, int k, int c) {
+                auto e = expected(vertex, k);
+                return c == 0 ? get<0>(e) : get<1>(e);
+            },
+            nabla->planes());
+        TypeParam::benchmark("fn_unstructured_nabla_soa_field_of_tuples", comp);
+    }
+
+    GT_REGRESSION_TEST(fn_unstructured_nabla_csr_field_of_tuples, test_environment<>, fn_backend_t) {
+        using float_t = typename TypeParam::float_t;
+
+        auto mesh = TypeParam::fn_unstructured_mesh();
+        auto nabla = mesh.template make_storage<tuple<float_t, float_t>>(mesh.nvertices(), mesh.nlevels());
+        auto comp = make_comp_csr(fn_backend_t(), mesh, nabla);
+        comp();
+        auto expected = make_expected(mesh);
+        TypeParam::verify(expected, nabla);
+        TypeParam::benchmark("fn_unstructured_nabla_csr_field_of_tuples", comp);
+    }
+
     GT_REGRESSION_TEST(fn_unstructured_nabla_fused_field_of_tuples, test_environment<>, fn_backend_t) {
         using float_t = typename TypeParam::float_t;
 
@@ -10,6 +10,7 @@
 #include <gtest/gtest.h>
 
 #include <set>
+#include <string>
 
 #include <gridtools/common/hugepage_alloc.hpp>
 
@@ -36,6 +37,89 @@ namespace gridtools {
 
         TEST(hugepage_alloc, page_size) { EXPECT_GT(hugepage_alloc_impl_::page_size(), 0); }
 
+        TEST(hugepage_alloc, parse_node_list) {
+            hugepage_alloc_impl_::numa_config config;
+            EXPECT_TRUE(hugepage_alloc_impl_::parse_node_list("0-2,5\n", config));
+            EXPECT_EQ(config.nodes[0], 0b100111ul);
+            EXPECT_FALSE(hugepage_alloc_impl_::parse_node_list("x", config));
+        }
+
+        TEST(hugepage_alloc, numa_config_from_env) {
+            setenv("GT_NUMA_POLICY", "bind:1", 1);
+            auto config = hugepage_alloc_impl_::numa_config_from_env();
+            EXPECT_EQ(config.policy, hugepage_alloc_impl_::numa_policy::bind);
+            EXPECT_EQ(config.nodes[0], 0b10ul);
+
+            setenv("GT_NUMA_POLICY", "interleave", 1);
+            config = hugepage_alloc_impl_::numa_config_from_env();
+            EXPECT_EQ(config.policy, hugepage_alloc_impl_::numa_policy::interleave);
+            EXPECT_TRUE(config.has_nodes());
+
+            // the allocation works even if the policy can not be applied
+            int *ptr = static_cast<int *>(hugepage_alloc(1000 * sizeof(int)));
+            for (int i = 0; i < 1000; ++i)
+                ptr[i] = i;
+            EXPECT_EQ(ptr[999], 999);
+            hugepage_free(ptr);
+
+            unsetenv("GT_NUMA_POLICY");
+            config = hugepage_alloc_impl_::numa_config_from_env();
+            EXPECT_EQ(config.policy, hugepage_alloc_impl_::numa_policy::none);
+        }
+
+        TEST(hugepage_alloc, size_class) {
+            std::size_t granularity = 4096;
+            EXPECT_EQ(hugepage_alloc_impl_::size_class(1, granularity), granularity);
+            EXPECT_EQ(hugepage_alloc_impl_::size_class(3 * granularity, granularity), 3 * granularity);
+            EXPECT_EQ(hugepage_alloc_impl_::size_class(17 * granularity, granularity), 20 * granularity);
+            for (std::size_t size = 1; size < 1000 * granularity; size = size * 3 / 2 + 1) {
+                auto res = hugepage_alloc_impl_::size_class(size, granularity);
+                EXPECT_GE(res, size);
+                EXPECT_LE(res, size / 4 * 5 + granularity);
+                EXPECT_EQ(res % granularity, 0);
+            }
+        }
+
+        TEST(hugepage_alloc, pool) {
+            hugepage_pool_set_limit(std::size_t(1) << 30);
+            auto before = hugepage_pool_get_statistics();
+            void *ptr = hugepage_alloc(100000);
+            EXPECT_GE(hugepage_pool_get_statistics().in_use_bytes, before.in_use_bytes + 100000);
+            hugepage_free(ptr);
+            EXPECT_GE(hugepage_pool_get_statistics().retained_bytes, 100000);
+            EXPECT_EQ(hugepage_pool_get_statistics().in_use_bytes, before.in_use_bytes);
+
+            // a slightly smaller allocation of the same size class reuses the memory
+            auto hits = hugepage_pool_get_statistics().hits;
+            ptr = hugepage_alloc(99000);
+            EXPECT_EQ(hugepage_pool_get_statistics().hits, hits + 1);
+            hugepage_free(ptr);
+
+            hugepage_pool_set_limit(0);
+            EXPECT_EQ(hugepage_pool_get_statistics().retained_bytes, 0);
+            hugepage_free(hugepage_alloc(100000));
+            EXPECT_EQ(hugepage_pool_get_statistics().retained_bytes, 0);
+            hugepage_pool_set_limit(std::size_t(1) << 30);
+        }
+
+        TEST(hugepage_alloc, no_size_classes_without_pool) {
+            const char *backup_mode = std::getenv("GT_HUGEPAGE_MODE");
+            std::string backup = backup_mode ? backup_mode : "";
+            setenv("GT_HUGEPAGE_MODE", "disable", 1);
+            std::size_t granularity = hugepage_alloc_impl_::page_size();
+            hugepage_pool_set_limit(0);
+            auto before = hugepage_pool_get_statistics().in_use_bytes;
+            void *ptr = hugepage_alloc(17 * granularity);
+            // the size class would be 20 pages, the offset adds at most one page
+            EXPECT_LE(hugepage_pool_get_statistics().in_use_bytes - before, 18 * granularity);
+            hugepage_free(ptr);
+            hugepage_pool_set_limit(std::size_t(1) << 30);
+            if (backup.empty())
+                unsetenv("GT_HUGEPAGE_MODE");
+            else
+                setenv("GT_HUGEPAGE_MODE", backup.c_str(), 1);
+        }
+
         struct hugepage_alloc_fixture : ::testing::TestWithParam<std::string> {
             std::string backup_mode;
             void SetUp() {
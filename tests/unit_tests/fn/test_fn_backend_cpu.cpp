@@ -0,0 +1,274 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gridtools/fn/backend/cpu.hpp>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/fn/column_stage.hpp>
+#include <gridtools/fn/stencil_stage.hpp>
+#include <gridtools/sid/composite.hpp>
+#include <gridtools/sid/multi_shift.hpp>
+#include <gridtools/sid/sid_shift_origin.hpp>
+#include <gridtools/sid/synthetic.hpp>
+
+namespace gridtools::fn::backend {
+    namespace {
+        using namespace literals;
+        using sid::property;
+
+        template <int I>
+        using int_t = integral_constant<int, I>;
+
+        using block_sizes_t = meta::list<meta::list<int_t<0>, int_t<2>>, meta::list<int_t<1>, int_t<3>>>;
+
+        struct stencil {
+            GT_FUNCTION constexpr auto operator()() const {
+                return [](auto const &iter) { return 2 * *iter; };
+            }
+        };
+
+        struct sum_scan : fwd {
+            static GT_FUNCTION constexpr auto body() {
+                return scan_pass(
+                    [](auto acc, auto const &iter) { return tuple(get<0>(acc) + *iter, get<1>(acc) * *iter); },
+                    [](auto acc) { return get<0>(acc); });
+            }
+        };
+
+        struct make_iterator_mock {
+            auto operator()() const {
+                return [](auto tag, auto const &ptr, auto const &) { return at_key<decltype(tag)>(ptr); };
+            }
+        };
+
+        auto as_synthetic(int x[5][7][3]) {
+            return sid::synthetic()
+                .set<property::origin>(sid::host_device::simple_ptr_holder(&x[0][0][0]))
+                .set<property::strides>(tuple(21_c, 3_c, 1_c));
+        }
+
+        TEST(backend_cpu, apply_stencil_stage) {
+            int in[5][7][3], out[5][7][3] = {};
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k)
+                        in[i][j][k] = 21 * i + 3 * j + k;
+
+            auto composite = sid::composite::keys<int_t<0>, int_t<1>>::make_values(as_synthetic(out), as_synthetic(in));
+
+            auto sizes = hymap::keys<int_t<0>, int_t<1>, int_t<2>>::values<int_t<5>, int_t<7>, int_t<3>>();
+
+            apply_stencil_stage(
+                cpu<block_sizes_t>(), sizes, stencil_stage<stencil, 0, 1>(), make_iterator_mock(), composite);
+
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k)
+                        EXPECT_EQ(out[i][j][k], 2 * in[i][j][k]);
+        }
+
+        TEST(backend_cpu, apply_column_stage) {
+            int in[5][7][3], out[5][7][3] = {};
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k)
+                        in[i][j][k] = 21 * i + 3 * j + k;
+
+            auto composite = sid::composite::keys<int_t<0>, int_t<1>>::make_values(as_synthetic(out), as_synthetic(in));
+
+            auto sizes = hymap::keys<int_t<0>, int_t<1>, int_t<2>>::values<int_t<5>, int_t<7>, int_t<3>>();
+
+            column_stage<int_t<1>, sum_scan, 0, 1> cs;
+
+            apply_column_stage(
+                cpu<block_sizes_t>(), sizes, cs, make_iterator_mock(), composite, int_t<1>(), tuple(42, 1));
+
+            for (int i = 0; i < 5; ++i)
+                for (int k = 0; k < 3; ++k) {
+                    int res = 42;
+                    for (int j = 0; j < 7; ++j) {
+                        res += in[i][j][k];
+                        EXPECT_EQ(out[i][j][k], res);
+                    }
+                }
+        }
+
+        TEST(backend_cpu, apply_column_stage_lockstep) {
+            int in[5][7][3], out[5][7][3] = {};
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k)
+                        in[i][j][k] = 21 * i + 3 * j + k;
+
+            auto composite = sid::composite::keys<int_t<0>, int_t<1>>::make_values(as_synthetic(out), as_synthetic(in));
+
+            auto sizes = hymap::keys<int_t<0>, int_t<1>, int_t<2>>::values<int_t<5>, int_t<7>, int_t<3>>();
+
+            column_stage<int_t<0>, sum_scan, 0, 1> cs;
+
+            apply_column_stage(cpu<block_sizes_t, thread_pool::omp, int_t<2>>(),
+                sizes,
+                cs,
+                make_iterator_mock(),
+                composite,
+                int_t<0>(),
+                tuple(42, 1));
+
+            for (int j = 0; j < 7; ++j)
+                for (int k = 0; k < 3; ++k) {
+                    int res = 42;
+                    for (int i = 0; i < 5; ++i) {
+                        res += in[i][j][k];
+                        EXPECT_EQ(out[i][j][k], res);
+                    }
+                }
+        }
+
+        // the first dimension has unit stride
+        auto as_synthetic_transposed(int x[3][7][5]) {
+            return sid::synthetic()
+                .set<property::origin>(sid::host_device::simple_ptr_holder(&x[0][0][0]))
+                .set<property::strides>(tuple(1_c, 5_c, 35_c));
+        }
+
+        TEST(backend_cpu, lane_dim_index) {
+            int in[3][7][5], out[3][7][5] = {};
+            auto composite = sid::composite::keys<int_t<0>, int_t<1>>::make_values(
+                as_synthetic_transposed(out), as_synthetic_transposed(in));
+            auto strides = sid::get_strides(composite);
+            using sids_t = meta::list<int_t<0>, int_t<1>>;
+            EXPECT_EQ((cpu_impl_::lane_dim_index<meta::list<int_t<0>, int_t<1>>, sids_t>(strides)), 0);
+            EXPECT_EQ((cpu_impl_::lane_dim_index<meta::list<int_t<1>, int_t<2>>, sids_t>(strides)), 0);
+            EXPECT_EQ((cpu_impl_::lane_dim_index<meta::list<int_t<2>, int_t<1>>, sids_t>(strides)), 1);
+        }
+
+        TEST(backend_cpu, apply_column_stage_lockstep_unit_stride) {
+            int in[3][7][5], out[3][7][5] = {};
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k)
+                        in[k][j][i] = 21 * i + 3 * j + k;
+
+            auto composite = sid::composite::keys<int_t<0>, int_t<1>>::make_values(
+                as_synthetic_transposed(out), as_synthetic_transposed(in));
+
+            auto sizes = hymap::keys<int_t<0>, int_t<1>, int_t<2>>::values<int_t<5>, int_t<7>, int_t<3>>();
+
+            column_stage<int_t<2>, sum_scan, 0, 1> cs;
+
+            apply_column_stage(cpu<block_sizes_t, thread_pool::omp, int_t<2>>(),
+                sizes,
+                cs,
+                make_iterator_mock(),
+                composite,
+                int_t<2>(),
+                tuple(42, 1));
+
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j) {
+                    int res = 42;
+                    for (int k = 0; k < 3; ++k) {
+                        res += in[k][j][i];
+                        EXPECT_EQ(out[k][j][i], res);
+                    }
+                }
+        }
+
+        TEST(backend_cpu, apply_stencil_stages_with_tmps) {
+            int in[5][7][3], out[5][7][3] = {};
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k)
+                        in[i][j][k] = 21 * i + 3 * j + k;
+
+            auto offsets = hymap::keys<int_t<0>>::make_values(1);
+            auto sids = std::tuple(sid::shift_sid_origin(as_synthetic(out), offsets),
+                sid::shift_sid_origin(as_synthetic(in), offsets),
+                local_tmp<int, extents<extent<int_t<0>, -1, 1>>>());
+
+            auto sizes = hymap::keys<int_t<0>, int_t<1>, int_t<2>>::values<int_t<3>, int_t<7>, int_t<3>>();
+
+            apply_stencil_stages_with_tmps(cpu<block_sizes_t>(),
+                sizes,
+                meta::list<stencil_stage<stencil, 2, 1>, stencil_stage<stencil, 0, 2>>(),
+                make_iterator_mock(),
+                std::move(sids));
+
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k)
+                        EXPECT_EQ(out[i][j][k], i == 0 || i == 4 ? 0 : 4 * in[i][j][k]);
+        }
+
+        // all iterators point to the next element along the first dimension
+        struct make_shifted_iterator_mock {
+            auto operator()() const {
+                return [](auto tag, auto const &ptr, auto const &strides) {
+                    return sid::shifted(
+                        at_key<decltype(tag)>(ptr), sid::get_stride_element<decltype(tag), int_t<0>>(strides), 1_c);
+                };
+            }
+        };
+
+        TEST(backend_cpu, apply_stencil_stages_with_tmps_untiled) {
+            int in[5][7][3], out[5][7][3] = {}, res[5][7][3] = {};
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k)
+                        in[i][j][k] = 21 * i + 3 * j + k;
+
+            auto sids = std::tuple(as_synthetic(out),
+                as_synthetic(in),
+                as_synthetic(res),
+                local_tmp<int, extents<extent<int_t<0>, 0, 1>>>());
+            using stages_t = meta::list<stencil_stage<stencil, 0, 1>,
+                stencil_stage<stencil, 3, 0>,
+                stencil_stage<stencil, 2, 3>>;
+
+            // the second stage reads the output of the first one in the neighbouring tile
+            static_assert(!cpu_impl_::is_tileable<decltype(sids), stages_t>::value);
+            static_assert(cpu_impl_::is_tileable<decltype(sids), meta::list<stencil_stage<stencil, 3, 1>,
+                                                                     stencil_stage<stencil, 0, 3>>>::value);
+
+            auto sizes = hymap::keys<int_t<0>, int_t<1>, int_t<2>>::values<int_t<3>, int_t<7>, int_t<3>>();
+
+            apply_stencil_stages_with_tmps(
+                cpu<block_sizes_t>(), sizes, stages_t(), make_shifted_iterator_mock(), std::move(sids));
+
+            for (int i = 0; i < 3; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k)
+                        EXPECT_EQ(res[i][j][k], i == 0 ? 8 * in[3][j][k] : 0);
+        }
+
+        TEST(backend_cpu, global_tmp) {
+            auto alloc = tmp_allocator(cpu<block_sizes_t>());
+            auto sizes = hymap::keys<int_t<0>, int_t<1>, int_t<2>>::values<int_t<5>, int_t<7>, int_t<3>>();
+            auto tmp = allocate_global_tmp(alloc, sizes, data_type<int>());
+            static_assert(sid::is_sid<decltype(tmp)>());
+
+            auto ptr = sid::get_origin(tmp)();
+            auto strides = sid::get_strides(tmp);
+            auto at = [&](int i, int j, int k) -> int & {
+                return *sid::multi_shifted(
+                    ptr, strides, hymap::keys<int_t<0>, int_t<1>, int_t<2>>::make_values(i, j, k));
+            };
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k)
+                        at(i, j, k) = 21 * i + 3 * j + k;
+
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    for (int k = 0; k < 3; ++k)
+                        EXPECT_EQ(at(i, j, k), 21 * i + 3 * j + k);
+        }
+    } // namespace
+} // namespace gridtools::fn::backend
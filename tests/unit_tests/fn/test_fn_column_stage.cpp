@@ -97,5 +97,50 @@ namespace gridtools::fn {
             }
         }
 
+        TEST(scan, lockstep) {
+            using vdim_t = integral_constant<int, 0>;
+            using hdim_t = integral_constant<int, 1>;
+
+            int a[5][3] = {};
+            int b[5][3];
+            for (int k = 0; k < 5; ++k)
+                for (int i = 0; i < 3; ++i)
+                    b[k][i] = 10 * i + k + 1;
+            auto as_synthetic = [](int x[5][3]) {
+                return sid::synthetic()
+                    .set<property::origin>(sid::host_device::simple_ptr_holder(&x[0][0]))
+                    .set<property::strides>(tuple(3_c, 1_c));
+            };
+            auto composite = sid::composite::keys<integral_constant<int, 0>, integral_constant<int, 1>>::make_values(
+                as_synthetic(a), as_synthetic(b));
+            auto ptr = sid::get_origin(composite)();
+            auto strides = sid::get_strides(composite);
+
+            {
+                column_stage<vdim_t, sum_fold_with_logues, 0, 1> cs;
+                auto res = cs.lockstep<3, hdim_t>(array<int, 3>{42, 43, 44}, 5, make_iterator_mock()(), ptr, strides);
+                for (int i = 0; i < 3; ++i)
+                    EXPECT_EQ(res[i],
+                        cs(42 + i,
+                            5,
+                            make_iterator_mock()(),
+                            sid::shifted(ptr, sid::get_stride<hdim_t>(strides), i),
+                            strides));
+            }
+
+            {
+                merged_column_stage<column_stage<vdim_t, sum_scan, 0, 1>, column_stage<vdim_t, sum_scan, 0, 1>> cs;
+                auto seeds = array<tuple<int, int>, 3>{tuple(0, 1), tuple(0, 1), tuple(0, 1)};
+                auto res = cs.lockstep<3, hdim_t>(seeds, 5, make_iterator_mock()(), ptr, strides);
+                for (int i = 0; i < 3; ++i) {
+                    int sum = 0;
+                    for (int k = 0; k < 5; ++k) {
+                        sum += b[k][i];
+                        EXPECT_EQ(a[k][i], 50 * i + 15 + sum);
+                    }
+                    EXPECT_EQ(get<0>(res[i]), 2 * (50 * i + 15));
+                }
+            }
+        }
     } // namespace
 } // namespace gridtools::fn
@@ -11,6 +11,7 @@
 
 #include <gtest/gtest.h>
 
+#include <gridtools/fn/backend/cpu.hpp>
 #include <gridtools/fn/backend/naive.hpp>
 #include <gridtools/fn/column_stage.hpp>
 
@@ -72,6 +73,131 @@ namespace gridtools::fn {
                 }
         }
 
+        TEST(stencil_executor, local_tmp) {
+            using backend_t = backend::naive;
+            auto domain = hymap::keys<int_t<0>, int_t<1>>::make_values(2_c, 3_c);
+
+            int a[2][3] = {}, c[2][3];
+            for (int i = 0; i < 2; ++i)
+                for (int j = 0; j < 3; ++j)
+                    c[i][j] = 3 * i + j;
+
+            make_stencil_executor(backend_t(), domain, std::tuple<>(), make_iterator_mock())
+                .arg(a)
+                .arg(c)
+                .tmp<int>()
+                .assign(2_c, stencil(), 1_c)
+                .assign(0_c, stencil(), 2_c)
+                .execute();
+
+            for (int i = 0; i < 2; ++i)
+                for (int j = 0; j < 3; ++j)
+                    EXPECT_EQ(a[i][j], (3 * i + j) * 4);
+        }
+
+        TEST(stencil_executor, plan) {
+            using backend_t = backend::naive;
+            auto domain = hymap::keys<int_t<0>, int_t<1>>::make_values(2_c, 3_c);
+
+            int a[2][3] = {}, b[2][3] = {}, c[2][3], d[2][3];
+            for (int i = 0; i < 2; ++i)
+                for (int j = 0; j < 3; ++j) {
+                    c[i][j] = 3 * i + j;
+                    d[i][j] = -(3 * i + j);
+                }
+
+            auto plan = make_stencil_executor(backend_t(), domain, std::tuple<>(), make_iterator_mock())
+                            .arg(a)
+                            .arg(b)
+                            .arg(c)
+                            .assign(1_c, stencil(), 2_c)
+                            .assign(0_c, stencil(), 1_c)
+                            .plan(tmp_allocator(backend_t()));
+
+            plan.execute();
+            for (int i = 0; i < 2; ++i)
+                for (int j = 0; j < 3; ++j) {
+                    EXPECT_EQ(a[i][j], (3 * i + j) * 4);
+                    EXPECT_EQ(b[i][j], (3 * i + j) * 2);
+                }
+
+            plan.rebind(2_c, d).execute();
+            for (int i = 0; i < 2; ++i)
+                for (int j = 0; j < 3; ++j) {
+                    EXPECT_EQ(a[i][j], -(3 * i + j) * 4);
+                    EXPECT_EQ(b[i][j], -(3 * i + j) * 2);
+                    EXPECT_EQ(c[i][j], (3 * i + j) * 1);
+                }
+        }
+
+        TEST(stencil_executor, plan_local_tmp) {
+            using backend_t = backend::naive;
+            auto domain = hymap::keys<int_t<0>, int_t<1>>::make_values(2_c, 3_c);
+
+            int a[2][3] = {}, c[2][3], d[2][3];
+            for (int i = 0; i < 2; ++i)
+                for (int j = 0; j < 3; ++j) {
+                    c[i][j] = 3 * i + j;
+                    d[i][j] = -(3 * i + j);
+                }
+
+            auto plan = make_stencil_executor(backend_t(), domain, std::tuple<>(), make_iterator_mock())
+                            .arg(a)
+                            .arg(c)
+                            .tmp<int>()
+                            .assign(2_c, stencil(), 1_c)
+                            .assign(0_c, stencil(), 2_c)
+                            .plan();
+
+            plan.execute();
+            for (int i = 0; i < 2; ++i)
+                for (int j = 0; j < 3; ++j)
+                    EXPECT_EQ(a[i][j], (3 * i + j) * 4);
+
+            plan.rebind(1_c, d).execute();
+            for (int i = 0; i < 2; ++i)
+                for (int j = 0; j < 3; ++j) {
+                    EXPECT_EQ(a[i][j], -(3 * i + j) * 4);
+                    EXPECT_EQ(c[i][j], 3 * i + j);
+                }
+        }
+
+        // the cpu backend runs the stages of the plan tile by tile with per thread temporaries
+        TEST(stencil_executor, plan_matches_execute_cpu) {
+            using backend_t = backend::cpu<meta::list<meta::list<int_t<0>, int_t<2>>, meta::list<int_t<1>, int_t<3>>>>;
+            auto domain = hymap::keys<int_t<0>, int_t<1>>::make_values(5_c, 7_c);
+
+            int a[5][7] = {}, b[5][7] = {}, c[5][7];
+            for (int i = 0; i < 5; ++i)
+                for (int j = 0; j < 7; ++j)
+                    c[i][j] = 7 * i + j;
+
+            make_stencil_executor(backend_t(), domain, std::tuple<>(), make_iterator_mock())
+                .arg(a)
+                .arg(c)
+                .tmp<int>()
+                .assign(2_c, stencil(), 1_c)
+                .assign(0_c, stencil(), 2_c)
+                .execute();
+
+            auto plan = make_stencil_executor(backend_t(), domain, std::tuple<>(), make_iterator_mock())
+                            .arg(b)
+                            .arg(c)
+                            .tmp<int>()
+                            .assign(2_c, stencil(), 1_c)
+                            .assign(0_c, stencil(), 2_c)
+                            .plan(tmp_allocator(backend_t()));
+
+            for (int step = 0; step < 2; ++step) {
+                plan.execute();
+                for (int i = 0; i < 5; ++i)
+                    for (int j = 0; j < 7; ++j) {
+                        EXPECT_EQ(a[i][j], (7 * i + j) * 4);
+                        EXPECT_EQ(b[i][j], a[i][j]);
+                    }
+            }
+        }
+
         TEST(vertical_executor, smoke) {
             using backend_t = backend::naive;
             auto domain = hymap::keys<int_t<0>, int_t<1>>::make_values(2_c, 3_c);
@@ -103,5 +229,31 @@ namespace gridtools::fn {
                 }
             }
         }
+
+        TEST(vertical_executor, plan) {
+            using backend_t = backend::naive;
+            auto domain = hymap::keys<int_t<0>, int_t<1>>::make_values(2_c, 3_c);
+
+            int a[2][3] = {}, c[2][3];
+            auto plan = make_vertical_executor<int_t<1>>(backend_t(), domain, std::tuple<>(), make_iterator_mock())
+                            .arg(a)
+                            .arg(c)
+                            .assign(0_c, fwd_sum_scan(), 42, 1_c)
+                            .plan();
+
+            for (int step = 0; step < 3; ++step) {
+                for (int i = 0; i < 2; ++i)
+                    for (int j = 0; j < 3; ++j)
+                        c[i][j] = step * (3 * i + j);
+                plan.execute();
+                for (int i = 0; i < 2; ++i) {
+                    int res = 42;
+                    for (int j = 0; j < 3; ++j) {
+                        res += c[i][j];
+                        EXPECT_EQ(a[i][j], res);
+                    }
+                }
+            }
+        }
     } // namespace
 } // namespace gridtools::fn
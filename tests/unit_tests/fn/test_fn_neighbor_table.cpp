@@ -11,9 +11,12 @@
 
 #include <array>
 #include <tuple>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include <gridtools/fn/csr_neighbor_table.hpp>
+
 namespace gridtools::fn {
     struct a_neighbor_table {};
     std::array<int, 3> neighbor_table_neighbors(a_neighbor_table, int) { return {1, 2, 42}; }
@@ -22,10 +25,54 @@ namespace gridtools::fn {
     static_assert(neighbor_table::is_neighbor_table<std::array<int, 3>[]>());
     static_assert(neighbor_table::is_neighbor_table<std::tuple<int, int, int>[]>());
     static_assert(!neighbor_table::is_neighbor_table<int>());
+    static_assert(neighbor_table::is_neighbor_table<csr_neighbor_table<4>>());
+
+    static_assert(neighbor_table::is_compressed_neighbor_table<csr_neighbor_table<4>>());
+    static_assert(!neighbor_table::is_compressed_neighbor_table<std::array<int, 3> const *>());
+
+    static_assert(!neighbor_table::is_dense_neighbor_table<std::array<int, 3> const *>());
+    static_assert(neighbor_table::is_dense_neighbor_table<neighbor_table::dense_neighbor_table<a_neighbor_table>>());
+    static_assert(neighbor_table::is_neighbor_table<neighbor_table::dense_neighbor_table<a_neighbor_table>>());
 
     TEST(neighbor_table, smoke) {
         std::array<int, 2> table[3] = {{1, 2}, {3, 4}, {4, 5}};
         for (int i = 0; i < 3; ++i)
             EXPECT_EQ(table[i], neighbor_table::neighbors(table, i));
     }
+
+    TEST(neighbor_table, for_each_neighbor) {
+        std::array<int, 3> table[2] = {{1, -1, 2}, {-1, -1, -1}};
+        std::vector<std::pair<int, int>> visited;
+        neighbor_table::for_each_neighbor(&table[0], 0, [&](int n, int i) { visited.emplace_back(n, i); });
+        neighbor_table::for_each_neighbor(&table[0], 1, [&](int n, int i) { visited.emplace_back(n, i); });
+        EXPECT_EQ(visited, (std::vector<std::pair<int, int>>{{1, 0}, {2, 2}}));
+    }
+
+    TEST(neighbor_table, dense) {
+        std::array<int, 2> table[2] = {{1, 0}, {0, 1}};
+        auto dense = neighbor_table::dense(&table[0]);
+        EXPECT_EQ(neighbor_table::neighbors(dense, 1), table[1]);
+        std::vector<std::pair<int, int>> visited;
+        neighbor_table::for_each_neighbor(dense, 0, [&](int n, int i) { visited.emplace_back(n, i); });
+        EXPECT_EQ(visited, (std::vector<std::pair<int, int>>{{1, 0}, {0, 1}}));
+    }
+
+    TEST(csr_neighbor_table, neighbors) {
+        int offsets[] = {0, 2, 2, 5};
+        int indices[] = {7, 3, 1, 4, 6};
+        auto table = make_csr_neighbor_table<4>(offsets, indices);
+        EXPECT_EQ(neighbor_table::neighbors(table, 0), (array<int, 4>{7, 3, -1, -1}));
+        EXPECT_EQ(neighbor_table::neighbors(table, 1), (array<int, 4>{-1, -1, -1, -1}));
+        EXPECT_EQ(neighbor_table::neighbors(table, 2), (array<int, 4>{1, 4, 6, -1}));
+    }
+
+    TEST(csr_neighbor_table, for_each_neighbor) {
+        int offsets[] = {0, 2, 2, 5};
+        int indices[] = {7, 3, 1, 4, 6};
+        auto table = make_csr_neighbor_table<4>(offsets, indices);
+        std::vector<std::pair<int, int>> visited;
+        for (int index = 0; index < 3; ++index)
+            neighbor_table::for_each_neighbor(table, index, [&](int n, int i) { visited.emplace_back(n, i); });
+        EXPECT_EQ(visited, (std::vector<std::pair<int, int>>{{7, 0}, {3, 1}, {1, 0}, {4, 1}, {6, 2}}));
+    }
 } // namespace gridtools::fn
@@ -0,0 +1,118 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gridtools/fn/renumbering.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_kfirst.hpp>
+
+namespace gridtools::fn::renumbering {
+    namespace {
+        bool is_permutation(std::vector<int> perm, int size) {
+            std::vector<int> expected(size);
+            std::iota(expected.begin(), expected.end(), 0);
+            std::sort(perm.begin(), perm.end());
+            return perm == expected;
+        }
+
+        // points of a 4x4 grid, numbered row by row
+        std::vector<std::tuple<double, double>> grid_points() {
+            std::vector<std::tuple<double, double>> res;
+            for (int j = 0; j < 4; ++j)
+                for (int i = 0; i < 4; ++i)
+                    res.emplace_back(i, j);
+            return res;
+        }
+
+        TEST(renumbering, inverse) {
+            std::vector<int> perm = {2, 0, 3, 1};
+            auto inv = inverse(perm);
+            for (int i = 0; i < 4; ++i)
+                EXPECT_EQ(inv[perm[i]], i);
+        }
+
+        TEST(renumbering, morton_order) {
+            auto perm = morton_order(grid_points());
+            ASSERT_TRUE(is_permutation(perm, 16));
+            std::vector<int> expected = {0, 1, 4, 5, 2, 3, 6, 7, 8, 9, 12, 13, 10, 11, 14, 15};
+            EXPECT_EQ(perm, expected);
+        }
+
+        TEST(renumbering, hilbert_order) {
+            auto points = grid_points();
+            auto perm = hilbert_order(points);
+            ASSERT_TRUE(is_permutation(perm, 16));
+            // consecutive points along the Hilbert curve are grid neighbors
+            for (int i = 1; i < 16; ++i) {
+                auto &&prev = points[perm[i - 1]];
+                auto &&cur = points[perm[i]];
+                EXPECT_EQ(
+                    std::abs(std::get<0>(prev) - std::get<0>(cur)) + std::abs(std::get<1>(prev) - std::get<1>(cur)), 1);
+            }
+        }
+
+        TEST(renumbering, reverse_cuthill_mckee) {
+            // a path 0 - 3 - 1 - 4 - 2 with scrambled numbering
+            std::array<int, 2> table[5] = {{3, -1}, {3, 4}, {4, -1}, {0, 1}, {1, 2}};
+            auto perm = reverse_cuthill_mckee(table, 5);
+            ASSERT_TRUE(is_permutation(perm, 5));
+            auto inv = inverse(perm);
+            // the bandwidth of the renumbered path is one
+            for (int i = 0; i < 5; ++i)
+                for (int n : table[i])
+                    EXPECT_TRUE(n == -1 || std::abs(inv[i] - inv[n]) == 1);
+        }
+
+        TEST(renumbering, permute_neighbor_table) {
+            std::array<int, 2> table[3] = {{1, -1}, {0, 2}, {1, -1}};
+            std::vector<int> perm = {2, 0, 1};
+            auto permuted = permute_neighbor_table(table, perm, perm);
+            auto inv = inverse(perm);
+            ASSERT_EQ(permuted.size(), 3);
+            for (int i = 0; i < 3; ++i)
+                for (int k = 0; k < 2; ++k) {
+                    int old = table[perm[i]][k];
+                    EXPECT_EQ(permuted[i][k], old == -1 ? -1 : inv[old]);
+                }
+        }
+
+        TEST(renumbering, data_store) {
+            auto builder = storage::builder<storage::cpu_kfirst>.type<double>().dimensions(5, 3);
+            std::vector<int> perm = {3, 0, 4, 1, 2};
+            auto init = [](int i, int k) { return 10. * i + k; };
+            auto src = builder.initializer(init).build();
+            auto permuted = builder.build();
+            auto expected = builder.initializer(permute_initializer(perm, init)).build();
+            auto restored = builder.build();
+
+            permute_data_store(perm, src, permuted);
+            unpermute_data_store(perm, permuted, restored);
+
+            auto permuted_view = permuted->const_host_view();
+            auto expected_view = expected->const_host_view();
+            auto restored_view = restored->const_host_view();
+            for (int i = 0; i < 5; ++i)
+                for (int k = 0; k < 3; ++k) {
+                    EXPECT_EQ(permuted_view(i, k), init(perm[i], k));
+                    EXPECT_EQ(expected_view(i, k), init(perm[i], k));
+                    EXPECT_EQ(restored_view(i, k), init(i, k));
+                }
+        }
+    } // namespace
+} // namespace gridtools::fn::renumbering
@@ -11,6 +11,8 @@
 
 #include <gtest/gtest.h>
 
+#include <gridtools/common/for_each.hpp>
+#include <gridtools/fn/backend/naive.hpp>
 #include <gridtools/sid/composite.hpp>
 #include <gridtools/sid/synthetic.hpp>
 
@@ -59,5 +61,79 @@ namespace gridtools::fn {
             EXPECT_EQ(out[0], 336);
         }
 
+        // independent stages are fused
+        static_assert(std::is_same_v<fuse_stencil_stages<meta::list<stencil_stage<stencil, 0, 2>,
+                                         stencil_stage<stencil, 1, 2>,
+                                         stencil_stage<stencil, 3, 1>>>,
+            meta::list<merged_stencil_stage<stencil_stage<stencil, 0, 2>, stencil_stage<stencil, 1, 2>>,
+                stencil_stage<stencil, 3, 1>>>);
+
+        // a stage that writes to an input of a previous stage is not fused
+        static_assert(std::is_same_v<
+            fuse_stencil_stages<meta::list<stencil_stage<stencil, 0, 1>, stencil_stage<stencil, 1, 2>>>,
+            meta::list<stencil_stage<stencil, 0, 1>, stencil_stage<stencil, 1, 2>>>);
+
+        static_assert(std::is_same_v<fuse_stencil_stages<meta::list<>>, meta::list<>>);
+
+        // the iterator is called with the offset along the single dimension
+        struct make_shifting_iterator {
+            GT_FUNCTION auto operator()() const {
+                return [](auto tag, auto const &ptr, auto const &strides) {
+                    return [ptr, &strides](int offset) {
+                        auto shifted = ptr;
+                        sid::shift(shifted, sid::get_stride<int_t<0>>(strides), offset);
+                        return *at_key<decltype(tag)>(shifted);
+                    };
+                };
+            }
+        };
+
+        struct shifted_sum {
+            GT_FUNCTION constexpr auto operator()() const {
+                return [](auto const &iter) { return iter(0) + 2 * iter(1); };
+            }
+        };
+
+        constexpr int n = 10;
+
+        auto as_synthetic(int *x) {
+            return sid::synthetic()
+                .set<property::origin>(sid::host_device::simple_ptr_holder(x))
+                .set<property::strides>(tuple(1_c));
+        }
+
+        // runs the stages one after the other on the naive backend, the args have one element of halo
+        template <class Stages>
+        void run_stages(int (&data)[5][n + 1]) {
+            auto composite = sid::composite::keys<int_t<0>, int_t<1>, int_t<2>, int_t<3>, int_t<4>>::make_values(
+                as_synthetic(data[0]),
+                as_synthetic(data[1]),
+                as_synthetic(data[2]),
+                as_synthetic(data[3]),
+                as_synthetic(data[4]));
+            auto sizes = hymap::keys<int_t<0>>::make_values(n);
+            for_each<Stages>([&](auto stage) {
+                backend::apply_stencil_stage(backend::naive(), sizes, stage, make_shifting_iterator(), composite);
+            });
+        }
+
+        TEST(stencil_stage, fused_matches_unfused) {
+            using stages_t = meta::list<stencil_stage<shifted_sum, 0, 4>,
+                stencil_stage<shifted_sum, 1, 4>,
+                stencil_stage<shifted_sum, 2, 0>,
+                stencil_stage<shifted_sum, 3, 1>>;
+            static_assert(meta::length<fuse_stencil_stages<stages_t>>::value == 2);
+
+            int fused[5][n + 1] = {}, unfused[5][n + 1] = {};
+            for (int i = 0; i <= n; ++i)
+                fused[4][i] = unfused[4][i] = i * i;
+            run_stages<fuse_stencil_stages<stages_t>>(fused);
+            run_stages<stages_t>(unfused);
+            for (int a = 0; a < 5; ++a)
+                for (int i = 0; i <= n; ++i)
+                    EXPECT_EQ(fused[a][i], unfused[a][i]);
+            EXPECT_EQ(unfused[2][0], unfused[0][0] + 2 * unfused[0][1]);
+        }
+
     } // namespace
 } // namespace gridtools::fn
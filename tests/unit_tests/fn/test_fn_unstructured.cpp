@@ -12,6 +12,8 @@
 #include <gtest/gtest.h>
 
 #include <gridtools/fn/backend/naive.hpp>
+#include <gridtools/fn/csr_neighbor_table.hpp>
+#include <gridtools/sid/composite.hpp>
 #include <gridtools/sid/synthetic.hpp>
 
 namespace gridtools::fn {
@@ -35,6 +37,57 @@ namespace gridtools::fn {
             }
         };
 
+        template <class C>
+        struct for_each_neighbor_stencil {
+            GT_FUNCTION constexpr auto operator()() const {
+                return [](auto const &in) {
+                    int tmp = 0;
+                    for_each_neighbor(in, C(), [&](auto const &shifted, int) { tmp += deref(shifted); });
+                    return tmp;
+                };
+            }
+        };
+
+        template <class C, int MaxNeighbors>
+        struct dense_stencil {
+            GT_FUNCTION constexpr auto operator()() const {
+                return [](auto const &in) {
+                    int tmp = 0;
+                    tuple_util::host_device::for_each(
+                        [&](auto i) {
+                            auto shifted = shift(in, C(), i);
+                            static_assert(std::is_same_v<decltype(shifted), std::decay_t<decltype(in)>>);
+                            tmp += deref(shifted);
+                        },
+                        meta::rename<tuple, meta::make_indices_c<MaxNeighbors>>());
+                    return tmp;
+                };
+            }
+        };
+
+        template <class C>
+        struct sum_over_stencil {
+            GT_FUNCTION constexpr auto operator()() const {
+                return [](auto const &in, auto const &weights) {
+                    auto sum = sum_over(in, C());
+                    auto weighted = sum_over(in, C(), deref(weights));
+                    auto max = reduce(
+                        in, C(), [](int acc, int value, int) { return value > acc ? value : acc; }, -1);
+                    return make_tuple(sum, weighted, max);
+                };
+            }
+        };
+
+        template <class C>
+        struct for_each_neighbor_sum_over_stencil {
+            GT_FUNCTION constexpr auto operator()() const {
+                return [](auto const &in) {
+                    auto sum = sum_over(in, C());
+                    return make_tuple(tuple_get(0_c, sum), tuple_get(1_c, sum));
+                };
+            }
+        };
+
         struct v2v {};
         struct v2e {};
 
@@ -101,5 +154,142 @@ namespace gridtools::fn {
                 }
         }
 
+        TEST(unstructured, v2e_sum_dense) {
+            auto apply_stencil = [](auto &&executor, auto &out, auto const &in) {
+                executor().arg(out).arg(in).assign(0_c, dense_stencil<v2e, 2>(), 1_c).execute();
+            };
+            auto fencil = [&](auto const &v2e_table, int nvertices, int nlevels, auto &out, auto const &in) {
+                auto v2e_conn = connectivity<v2e>(neighbor_table::dense(v2e_table));
+                auto domain = unstructured_domain({nvertices, nlevels}, {}, v2e_conn);
+                auto backend = make_backend(backend::naive(), domain);
+                apply_stencil(backend.stencil_executor(), out, in);
+            };
+
+            std::array<int, 2> v2e_table[3] = {{0, 2}, {0, 1}, {1, 2}};
+
+            int in[3][5], out[3][5] = {};
+            for (int e = 0; e < 3; ++e)
+                for (int k = 0; k < 5; ++k)
+                    in[e][k] = 5 * e + k;
+
+            fencil(&v2e_table[0], 3, 5, out, in);
+
+            for (int v = 0; v < 3; ++v)
+                for (int k = 0; k < 5; ++k)
+                    EXPECT_EQ(out[v][k], in[v2e_table[v][0]][k] + in[v2e_table[v][1]][k]);
+        }
+
+        TEST(unstructured, v2v_sum_over) {
+            auto apply_stencil = [](auto &&executor, auto &out, auto const &in, auto const &weights) {
+                executor().arg(out).arg(in).arg(weights).assign(0_c, sum_over_stencil<v2v>(), 1_c, 2_c).execute();
+            };
+            auto fencil = [&](auto const &v2v_table, int nvertices, int nlevels, auto &out, auto const &in, auto &w) {
+                auto v2v_conn = connectivity<v2v>(v2v_table);
+                auto domain = unstructured_domain({nvertices, nlevels}, {}, v2v_conn);
+                auto backend = make_backend(backend::naive(), domain);
+                apply_stencil(backend.stencil_executor(), out, in, w);
+            };
+
+            std::array<int, 3> v2v_table[3] = {{1, 2, -1}, {0, -1, 2}, {0, 1, -1}};
+
+            int in[3][5];
+            for (int v = 0; v < 3; ++v)
+                for (int k = 0; k < 5; ++k)
+                    in[v][k] = 5 * v + k;
+            array<double, 3> weights[3];
+            for (int v = 0; v < 3; ++v)
+                for (int i = 0; i < 3; ++i)
+                    weights[v][i] = .5 * (v + i);
+            tuple<int, double, int> out[3][5];
+
+            fencil(&v2v_table[0], 3, 5, out, in, weights);
+
+            for (int v = 0; v < 3; ++v)
+                for (int k = 0; k < 5; ++k) {
+                    int sum = 0, max = -1;
+                    double wsum = 0;
+                    for (int i = 0; i < 3; ++i) {
+                        int nb = v2v_table[v][i];
+                        if (nb == -1)
+                            continue;
+                        sum += in[nb][k];
+                        wsum += weights[v][i] * in[nb][k];
+                        max = std::max(max, in[nb][k]);
+                    }
+                    EXPECT_EQ(tuple_get(0_c, out[v][k]), sum);
+                    EXPECT_DOUBLE_EQ(tuple_get(1_c, out[v][k]), wsum);
+                    EXPECT_EQ(tuple_get(2_c, out[v][k]), max);
+                }
+        }
+
+        TEST(unstructured, v2v_sum_over_tuple_of_references) {
+            auto apply_stencil = [](auto &&executor, auto &out, auto &in) {
+                executor().arg(out).arg(in).assign(0_c, for_each_neighbor_sum_over_stencil<v2v>(), 1_c).execute();
+            };
+            auto fencil = [&](auto const &v2v_table, int nvertices, int nlevels, auto &out, auto &in) {
+                auto v2v_conn = connectivity<v2v>(v2v_table);
+                auto domain = unstructured_domain({nvertices, nlevels}, {}, v2v_conn);
+                auto backend = make_backend(backend::naive(), domain);
+                apply_stencil(backend.stencil_executor(), out, in);
+            };
+
+            std::array<int, 3> v2v_table[3] = {{1, 2, -1}, {0, -1, 2}, {0, 1, -1}};
+
+            int in0[3][5], in1[3][5];
+            for (int v = 0; v < 3; ++v)
+                for (int k = 0; k < 5; ++k) {
+                    in0[v][k] = 5 * v + k;
+                    in1[v][k] = -v;
+                }
+            // the composite is dereferenced to a tuple of references
+            using keys_t = sid::composite::keys<integral_constant<int, 0>, integral_constant<int, 1>>;
+            keys_t::values<int(&)[3][5], int(&)[3][5]> in = {in0, in1};
+            tuple<int, int> out[3][5];
+
+            fencil(&v2v_table[0], 3, 5, out, in);
+
+            for (int v = 0; v < 3; ++v)
+                for (int k = 0; k < 5; ++k) {
+                    int sum0 = 0, sum1 = 0;
+                    for (int nb : v2v_table[v])
+                        if (nb != -1) {
+                            sum0 += in0[nb][k];
+                            sum1 += in1[nb][k];
+                        }
+                    EXPECT_EQ(tuple_get(0_c, out[v][k]), sum0);
+                    EXPECT_EQ(tuple_get(1_c, out[v][k]), sum1);
+                }
+        }
+
+        TEST(unstructured, v2v_sum_csr) {
+            auto apply_stencil = [](auto &&executor, auto &out, auto const &in) {
+                executor().arg(out).arg(in).assign(0_c, for_each_neighbor_stencil<v2v>(), 1_c).execute();
+            };
+            auto fencil = [&](auto const &v2v_table, int nvertices, int nlevels, auto &out, auto const &in) {
+                auto v2v_conn = connectivity<v2v>(v2v_table);
+                auto domain = unstructured_domain({nvertices, nlevels}, {}, v2v_conn);
+                auto backend = make_backend(backend::naive(), domain);
+                apply_stencil(backend.stencil_executor(), out, in);
+            };
+
+            int v2v_offsets[4] = {0, 2, 3, 5};
+            int v2v_indices[5] = {1, 2, 0, 0, 1};
+
+            int in[3][5], out[3][5] = {};
+            for (int v = 0; v < 3; ++v)
+                for (int k = 0; k < 5; ++k)
+                    in[v][k] = 5 * v + k;
+
+            fencil(make_csr_neighbor_table<3>(v2v_offsets, v2v_indices), 3, 5, out, in);
+
+            for (int v = 0; v < 3; ++v)
+                for (int k = 0; k < 5; ++k) {
+                    int nbsum = 0;
+                    for (int i = v2v_offsets[v]; i < v2v_offsets[v + 1]; ++i)
+                        nbsum += in[v2v_indices[i]][k];
+                    EXPECT_EQ(out[v][k], nbsum);
+                }
+        }
+
     } // namespace
 } // namespace gridtools::fn
@@ -0,0 +1,89 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/reduction/fused.hpp>
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/common/hymap.hpp>
+#include <gridtools/reduction.hpp>
+#include <gridtools/reduction/cpu.hpp>
+#include <gridtools/reduction/naive.hpp>
+#include <gridtools/sid/concept.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+#include <gridtools/storage/cpu_kfirst.hpp>
+
+namespace gridtools {
+    namespace reduction {
+        namespace {
+            template <class Reducible, class F>
+            void fill(Reducible &testee, F f) {
+                auto ptr = sid::get_origin(testee)();
+                auto strides = sid::get_strides(testee);
+                for (int i = 0; i != 13; ++i)
+                    for (int j = 0; j != 17; ++j)
+                        for (int k = 0; k != 5; ++k)
+                            ptr[i * at_key<integral_constant<int, 0>>(strides) +
+                                j * at_key<integral_constant<int, 1>>(strides) +
+                                k * at_key<integral_constant<int, 2>>(strides)] = f(i, j, k);
+            }
+
+            double value(int i, int j, int k) { return 1 + (i * 31 + j * 17 + k * 7) % 23; }
+
+            template <class Backend, class StorageTraits>
+            void check() {
+                auto testee = make_reducible<Backend, StorageTraits>(0., 13, 17, 5);
+                fill(testee, value);
+                double sum = 0, min_val = 1e9, max_val = 0, squares = 0;
+                for (int i = 0; i != 13; ++i)
+                    for (int j = 0; j != 17; ++j)
+                        for (int k = 0; k != 5; ++k) {
+                            double x = value(i, j, k);
+                            sum += x;
+                            min_val = std::min(min_val, x);
+                            max_val = std::max(max_val, x);
+                            squares += x * x;
+                        }
+                // the padding holds the neutral value of `plus`, it must not affect `min`
+                auto res = testee.reduce(tuple(plus(), min(), max(), sum_of_squares()));
+                EXPECT_EQ(tuple_util::get<0>(res), sum);
+                EXPECT_EQ(tuple_util::get<1>(res), min_val);
+                EXPECT_EQ(tuple_util::get<2>(res), max_val);
+                EXPECT_EQ(tuple_util::get<3>(res), squares);
+            }
+
+            TEST(fused_reduce, naive) {
+                check<naive, storage::cpu_ifirst>();
+                check<naive, storage::cpu_kfirst>();
+            }
+
+            TEST(fused_reduce, cpu) {
+                check<cpu, storage::cpu_ifirst>();
+                check<cpu, storage::cpu_kfirst>();
+            }
+
+            TEST(fused_reduce, cpu_reproducible) { check<cpu_reproducible<>, storage::cpu_ifirst>(); }
+
+            TEST(fused_reduce, several_reducibles) {
+                auto a = make_reducible<cpu, storage::cpu_ifirst>(0., 13, 17, 5);
+                auto b = make_reducible<cpu, storage::cpu_ifirst>(0, 13, 17, 5);
+                fill(a, [](int i, int, int) { return i + .5; });
+                fill(b, [](int, int j, int k) { return j - k; });
+                auto res = fused_reduce(tuple(min(), max()), a, b);
+                EXPECT_EQ(tuple_util::get<0>(tuple_util::get<0>(res)), .5);
+                EXPECT_EQ(tuple_util::get<1>(tuple_util::get<0>(res)), 12.5);
+                EXPECT_EQ(tuple_util::get<0>(tuple_util::get<1>(res)), -4);
+                EXPECT_EQ(tuple_util::get<1>(tuple_util::get<1>(res)), 16);
+            }
+        } // namespace
+    }     // namespace reduction
+} // namespace gridtools
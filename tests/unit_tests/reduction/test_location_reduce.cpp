@@ -0,0 +1,137 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/reduction/location.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/reduction.hpp>
+#include <gridtools/reduction/cpu.hpp>
+#include <gridtools/reduction/naive.hpp>
+#include <gridtools/sid/concept.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+#include <gridtools/storage/cpu_kfirst.hpp>
+
+namespace gridtools {
+    namespace reduction {
+        namespace {
+            using index_t = std::array<int_t, 3>;
+
+            template <class Reducible>
+            auto &at(Reducible const &testee, index_t const &index) {
+                auto strides = tuple_util::convert_to<std::array, int_t>(sid::get_strides(testee));
+                int_t offset = 0;
+                for (size_t d = 0; d != 3; ++d)
+                    offset += index[d] * strides[d];
+                return sid::get_origin(testee)()[offset];
+            }
+
+            // many ties on purpose
+            double value(index_t const &index) { return (index[0] * 31 + index[1] * 17 + index[2] * 7) % 23; }
+
+            constexpr index_t sizes = {13, 17, 5};
+
+            std::vector<index_t> all_indices() {
+                std::vector<index_t> res;
+                for (int_t i = 0; i != sizes[0]; ++i)
+                    for (int_t j = 0; j != sizes[1]; ++j)
+                        for (int_t k = 0; k != sizes[2]; ++k)
+                            res.push_back({i, j, k});
+                return res;
+            }
+
+            // the serial reference: sorted by value, then lexicographically by index
+            template <class Better>
+            std::vector<index_t> sorted_indices(Better better) {
+                auto res = all_indices();
+                std::stable_sort(res.begin(), res.end(), [&](index_t const &lhs, index_t const &rhs) {
+                    return better(value(lhs), value(rhs));
+                });
+                return res;
+            }
+
+            template <class Backend, class StorageTraits>
+            auto make_testee() {
+                auto res = make_reducible<Backend, StorageTraits>(0., sizes[0], sizes[1], sizes[2]);
+                for (auto const &index : all_indices())
+                    at(res, index) = value(index);
+                return res;
+            }
+
+            template <class Backend, class StorageTraits>
+            void check() {
+                auto testee = make_testee<Backend, StorageTraits>();
+                auto ascending = sorted_indices([](double x, double y) { return x < y; });
+                auto descending = sorted_indices([](double x, double y) { return x > y; });
+
+                auto lowest = argmin(testee);
+                EXPECT_EQ(lowest.index, ascending.front());
+                EXPECT_EQ(lowest.value, value(ascending.front()));
+
+                auto highest = argmax(testee);
+                EXPECT_EQ(highest.index, descending.front());
+                EXPECT_EQ(highest.value, value(descending.front()));
+
+                auto top = top_k(max(), 50, testee);
+                ASSERT_EQ(top.size(), 50);
+                for (size_t n = 0; n != top.size(); ++n) {
+                    EXPECT_EQ(top[n].index, descending[n]);
+                    EXPECT_EQ(top[n].value, value(descending[n]));
+                }
+
+                auto bottom = top_k(min(), 3, testee);
+                ASSERT_EQ(bottom.size(), 3);
+                for (size_t n = 0; n != bottom.size(); ++n)
+                    EXPECT_EQ(bottom[n].index, ascending[n]);
+
+                EXPECT_EQ(top_k(min(), 10000, testee).size(), ascending.size());
+                EXPECT_TRUE(top_k(min(), 0, testee).empty());
+            }
+
+            TEST(location_reduce, naive_ifirst) { check<naive, storage::cpu_ifirst>(); }
+            TEST(location_reduce, naive_kfirst) { check<naive, storage::cpu_kfirst>(); }
+            TEST(location_reduce, cpu_ifirst) { check<cpu, storage::cpu_ifirst>(); }
+            TEST(location_reduce, cpu_kfirst) { check<cpu, storage::cpu_kfirst>(); }
+            TEST(location_reduce, cpu_reproducible) { check<cpu_reproducible<>, storage::cpu_kfirst>(); }
+
+            TEST(location_reduce, nan) {
+                auto testee = make_testee<cpu, storage::cpu_ifirst>();
+                double nan = std::numeric_limits<double>::quiet_NaN();
+                at(testee, {0, 0, 0}) = nan;
+                at(testee, {5, 3, 2}) = -1;
+                at(testee, {7, 1, 4}) = nan;
+                auto res = argmin(testee);
+                EXPECT_EQ(res.value, -1);
+                EXPECT_EQ(res.index, (index_t{5, 3, 2}));
+                for (auto const &item : top_k(max(), 100, testee))
+                    EXPECT_FALSE(std::isnan(item.value));
+
+                auto nans = make_reducible<cpu, storage::cpu_ifirst>(nan, 3, 4);
+                EXPECT_FALSE(argmax(nans).valid());
+                EXPECT_TRUE(top_k(max(), 2, nans).empty());
+            }
+
+            TEST(location_reduce, infinity) {
+                double inf = std::numeric_limits<double>::infinity();
+                auto testee = make_reducible<cpu, storage::cpu_ifirst>(inf, 9, 11);
+                auto res = argmin(testee);
+                ASSERT_TRUE(res.valid());
+                EXPECT_EQ(res.value, inf);
+                EXPECT_EQ(res.index, (std::array<int_t, 2>{0, 0}));
+            }
+        } // namespace
+    }     // namespace reduction
+} // namespace gridtools
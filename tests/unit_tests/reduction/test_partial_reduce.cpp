@@ -0,0 +1,90 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/reduction/partial.hpp>
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/common/hymap.hpp>
+#include <gridtools/reduction.hpp>
+#include <gridtools/reduction/cpu.hpp>
+#include <gridtools/reduction/naive.hpp>
+#include <gridtools/sid/concept.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+#include <gridtools/storage/cpu_kfirst.hpp>
+
+namespace gridtools {
+    namespace reduction {
+        namespace {
+            template <class Reducible, class... Is>
+            auto &at(Reducible const &testee, Is... is) {
+                auto strides = tuple_util::convert_to<std::array, int_t>(sid::get_strides(testee));
+                std::array<int_t, sizeof...(Is)> indices = {is...};
+                int_t offset = 0;
+                for (size_t d = 0; d != sizeof...(Is); ++d)
+                    offset += indices[d] * strides[d];
+                return sid::get_origin(testee)()[offset];
+            }
+
+            double value(int i, int j, int k) { return 1 + (i * 31 + j * 17 + k * 7) % 23; }
+
+            template <class Backend, class StorageTraits>
+            void check() {
+                auto testee = make_reducible<Backend, StorageTraits>(0., 13, 17, 5);
+                for (int i = 0; i != 13; ++i)
+                    for (int j = 0; j != 17; ++j)
+                        for (int k = 0; k != 5; ++k)
+                            at(testee, i, j, k) = value(i, j, k);
+
+                auto column_sums = partial_reduce<2>(plus(), testee);
+                for (int i = 0; i != 13; ++i)
+                    for (int j = 0; j != 17; ++j) {
+                        double expected = 0;
+                        for (int k = 0; k != 5; ++k)
+                            expected += value(i, j, k);
+                        EXPECT_EQ(at(column_sums, i, j), expected);
+                    }
+
+                auto level_max = partial_reduce<0, 1>(max(), testee);
+                for (int k = 0; k != 5; ++k) {
+                    double expected = 0;
+                    for (int i = 0; i != 13; ++i)
+                        for (int j = 0; j != 17; ++j)
+                            expected = std::max(expected, value(i, j, k));
+                    EXPECT_EQ(at(level_max, k), expected);
+                }
+
+                auto row_squares = partial_reduce<0>(sum_of_squares(), testee);
+                for (int j = 0; j != 17; ++j)
+                    for (int k = 0; k != 5; ++k) {
+                        double expected = 0;
+                        for (int i = 0; i != 13; ++i)
+                            expected += value(i, j, k) * value(i, j, k);
+                        EXPECT_EQ(at(row_squares, j, k), expected);
+                    }
+
+                // the result is reducible further
+                EXPECT_EQ(column_sums.reduce(plus()), tuple_util::get<0>(testee.reduce(tuple(plus()))));
+            }
+
+            TEST(partial_reduce, naive) {
+                check<naive, storage::cpu_ifirst>();
+                check<naive, storage::cpu_kfirst>();
+            }
+
+            TEST(partial_reduce, cpu) {
+                check<cpu, storage::cpu_ifirst>();
+                check<cpu, storage::cpu_kfirst>();
+            }
+        } // namespace
+    }     // namespace reduction
+} // namespace gridtools
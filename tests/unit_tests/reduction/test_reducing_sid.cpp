@@ -0,0 +1,123 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/reduction/reducing_sid.hpp>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/reduction.hpp>
+#include <gridtools/reduction/cpu.hpp>
+#include <gridtools/sid/concept.hpp>
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/cpu_ifirst.hpp>
+#include <gridtools/stencil/cpu_kfirst.hpp>
+#include <gridtools/stencil/naive.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+
+namespace gridtools {
+    namespace reduction {
+        namespace {
+            using namespace stencil;
+            using namespace cartesian;
+
+            static_assert(is_sid<decltype(make_reducing_sink<double>(plus(), 2, 3))>::value, "");
+
+            struct mul_functor {
+                using out = inout_accessor<0>;
+                using lhs = in_accessor<1>;
+                using rhs = in_accessor<2>;
+                using param_list = make_param_list<out, lhs, rhs>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    eval(out()) = eval(lhs()) * eval(rhs());
+                }
+            };
+
+            template <class Backend>
+            void check() {
+                auto builder = storage::builder<storage::cpu_ifirst>.template type<double>().dimensions(23, 19, 7);
+                auto lhs = builder.initializer([](int i, int j, int) { return i + j; }).build();
+                auto rhs = builder.initializer([](int, int, int k) { return k - 3; }).build();
+                double sum = 0, max_val = -1e9;
+                for (int i = 0; i != 23; ++i)
+                    for (int j = 0; j != 19; ++j)
+                        for (int k = 0; k != 7; ++k) {
+                            sum += (i + j) * (k - 3);
+                            max_val = std::max<double>(max_val, (i + j) * (k - 3));
+                        }
+                auto grid = make_grid(23, 19, 7);
+
+                auto sink = make_reducing_sink<double>(plus(), 23, 19, 7);
+                run_single_stage(mul_functor(), Backend(), grid, sink, lhs, rhs);
+                EXPECT_EQ(sink.result(), sum);
+
+                auto buffered = make_reducing_sid(max(), make_reducible<cpu, storage::cpu_ifirst>(0., 23, 19, 7));
+                run_single_stage(mul_functor(), Backend(), grid, buffered, lhs, rhs);
+                EXPECT_EQ(buffered.result(), max_val);
+                EXPECT_EQ(buffered.buffer().reduce(plus()), sum);
+
+                // the partial results are accumulated over the runs until reset
+                run_single_stage(mul_functor(), Backend(), grid, sink, lhs, rhs);
+                EXPECT_EQ(sink.result(), 2 * sum);
+                sink.reset();
+                EXPECT_EQ(sink.result(), 0);
+            }
+
+            TEST(reducing_sid, naive) { check<naive>(); }
+            TEST(reducing_sid, cpu_ifirst) { check<cpu_ifirst<>>(); }
+            TEST(reducing_sid, cpu_kfirst) { check<cpu_kfirst<>>(); }
+
+            struct copy_functor {
+                using out = inout_accessor<0>;
+                using tmp = inout_accessor<1>;
+                using in = in_accessor<2>;
+                using param_list = make_param_list<out, tmp, in>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    eval(out()) = eval(in());
+                    eval(tmp()) = eval(in());
+                }
+            };
+
+            struct shift_functor {
+                using out = inout_accessor<0>;
+                using in = in_accessor<1, extent<0, 1>>;
+                using param_list = make_param_list<out, in>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    eval(out()) = eval(in(1, 0, 0));
+                }
+            };
+
+            // the first stage is computed on the domain extended by one point along i
+            TEST(reducing_sid, extended_domain) {
+                auto builder = storage::builder<storage::cpu_ifirst>.type<double>().dimensions(24, 19, 7);
+                auto in = builder.value(1).build();
+                auto out = builder.build();
+                auto sink = make_reducing_sink<double>(plus(), 24, 20, 7);
+                run(
+                    [](auto sink, auto in, auto out) {
+                        GT_DECLARE_TMP(double, tmp);
+                        return execute_parallel().stage(copy_functor(), sink, tmp, in).stage(shift_functor(), out, tmp);
+                    },
+                    cpu_ifirst<>(),
+                    make_grid(23, 19, 7),
+                    sink,
+                    in,
+                    out);
+                EXPECT_THROW(sink.result(), std::runtime_error);
+            }
+        } // namespace
+    }     // namespace reduction
+} // namespace gridtools
@@ -0,0 +1,89 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/reduction/cpu.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/common/hymap.hpp>
+#include <gridtools/common/omp.hpp>
+#include <gridtools/reduction.hpp>
+#include <gridtools/sid/concept.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+
+namespace gridtools {
+    namespace reduction {
+        namespace {
+            template <class Backend, class T, class F>
+            T reduce_with_threads(int threads, F f, std::vector<T> const &data, T neutral) {
+                int old_threads = omp_get_max_threads();
+                omp_set_num_threads(threads);
+                T res = reduction_reduce(Backend(), neutral, f, data.data(), data.size());
+                omp_set_num_threads(old_threads);
+                return res;
+            }
+
+            std::vector<double> random_data(size_t n) {
+                std::vector<double> res(n);
+                std::srand(42);
+                for (auto &val : res)
+                    val = (std::rand() - RAND_MAX / 2) * (std::rand() % 2 ? 1e-8 : 1e8) / RAND_MAX;
+                return res;
+            }
+
+            TEST(cpu_reproducible, independent_of_threads) {
+                auto data = random_data(1000003);
+                double expected = reduce_with_threads<cpu_reproducible<>>(1, plus(), data, 0.);
+                for (int threads : {2, 3, 7})
+                    EXPECT_EQ(reduce_with_threads<cpu_reproducible<>>(threads, plus(), data, 0.), expected);
+                double compensated = reduce_with_threads<cpu_reproducible<neumaier>>(1, plus(), data, 0.);
+                for (int threads : {2, 3, 7})
+                    EXPECT_EQ(reduce_with_threads<cpu_reproducible<neumaier>>(threads, plus(), data, 0.), compensated);
+            }
+
+            TEST(cpu_reproducible, compensation) {
+                // the small values are lost in a plain summation
+                std::vector<double> data(100000, 1e-16);
+                data[0] = 1;
+                double exact = 1 + 1e-16 * (data.size() - 1);
+                EXPECT_EQ(reduction_reduce(cpu_reproducible<neumaier>(), 0., plus(), data.data(), data.size()), exact);
+                EXPECT_NE(reduction_reduce(cpu_reproducible<>(), 0., plus(), data.data(), data.size()), exact);
+            }
+
+            TEST(cpu_reproducible, other_functors) {
+                std::vector<int> data(10000);
+                for (size_t i = 0; i != data.size(); ++i)
+                    data[i] = (i * 7919) % 10007;
+                EXPECT_EQ(reduction_reduce(cpu_reproducible<neumaier>(), 0, plus(), data.data(), data.size()),
+                    reduction_reduce(cpu(), 0, plus(), data.data(), data.size()));
+                EXPECT_EQ(reduction_reduce(cpu_reproducible<>(), 1 << 30, min(), data.data(), data.size()), 0);
+                EXPECT_EQ(reduction_reduce(cpu_reproducible<>(), 0, max(), data.data(), data.size()), 10006);
+                EXPECT_EQ(reduction_reduce(cpu_reproducible<>(), 0, plus(), data.data(), 0), 0);
+            }
+
+            TEST(cpu_reproducible, reducible) {
+                auto testee = make_reducible<cpu_reproducible<neumaier>, storage::cpu_ifirst>(0., 13, 17, 5);
+                EXPECT_EQ(testee.reduce(plus()), 0);
+                auto ptr = sid::get_origin(testee)();
+                auto strides = sid::get_strides(testee);
+                for (int i = 0; i != 13; ++i)
+                    for (int j = 0; j != 17; ++j)
+                        for (int k = 0; k != 5; ++k)
+                            ptr[i * at_key<integral_constant<int, 0>>(strides) +
+                                j * at_key<integral_constant<int, 1>>(strides) +
+                                k * at_key<integral_constant<int, 2>>(strides)] = .5;
+                EXPECT_EQ(testee.reduce(plus()), 13 * 17 * 5 * .5);
+            }
+        } // namespace
+    }     // namespace reduction
+} // namespace gridtools
@@ -0,0 +1,82 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/sid/allocator.hpp>
+
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/meta.hpp>
+
+namespace gridtools {
+    namespace {
+        TEST(allocator, distinct_buffers) {
+            auto alloc = sid::allocator(&std::make_unique<char[]>);
+            auto first = allocate(alloc, meta::lazy::id<double>(), 10)();
+            auto second = allocate(alloc, meta::lazy::id<double>(), 10)();
+            EXPECT_NE(first, second);
+        }
+
+        TEST(cached_allocator, size_class) {
+            EXPECT_EQ(sid::allocator_impl_::size_class(1), 64);
+            EXPECT_EQ(sid::allocator_impl_::size_class(256), 256);
+            EXPECT_EQ(sid::allocator_impl_::size_class(1000), 1024);
+            EXPECT_EQ(sid::allocator_impl_::size_class(1100), 1280);
+            for (size_t size = 1; size < 100000000; size = size * 3 / 2 + 1) {
+                auto res = sid::allocator_impl_::size_class(size);
+                EXPECT_GE(res, size);
+                EXPECT_LE(res, size / 4 * 5 + 64);
+            }
+        }
+
+        TEST(cached_allocator, reuse) {
+            sid::set_cached_allocator_limit(size_t(1) << 30);
+            double *ptr;
+            {
+                auto alloc = sid::cached_allocator(&std::make_unique<char[]>);
+                ptr = allocate(alloc, meta::lazy::id<double>(), 1000)();
+            }
+            auto before = sid::cached_allocator_statistics();
+            EXPECT_GE(before.resident_bytes, 8000);
+            {
+                // a slightly different size of the same size class reuses the buffer
+                auto alloc = sid::cached_allocator(&std::make_unique<char[]>);
+                EXPECT_EQ(allocate(alloc, meta::lazy::id<double>(), 990)(), ptr);
+                auto after = sid::cached_allocator_statistics();
+                EXPECT_EQ(after.hits, before.hits + 1);
+                EXPECT_EQ(after.resident_bytes, before.resident_bytes - 8192);
+            }
+        }
+
+        TEST(cached_allocator, limit) {
+            sid::set_cached_allocator_limit(10000);
+            auto before = sid::cached_allocator_statistics();
+            {
+                auto alloc = sid::cached_allocator(&std::make_unique<char[]>);
+                allocate(alloc, meta::lazy::id<char>(), 6000);
+            }
+            {
+                auto alloc = sid::cached_allocator(&std::make_unique<char[]>);
+                allocate(alloc, meta::lazy::id<char>(), 5000);
+            }
+            auto after = sid::cached_allocator_statistics();
+            EXPECT_GT(after.evictions, before.evictions);
+            EXPECT_LE(after.resident_bytes, 10000);
+            {
+                // the most recently stashed buffer is kept
+                auto alloc = sid::cached_allocator(&std::make_unique<char[]>);
+                allocate(alloc, meta::lazy::id<char>(), 5000);
+                EXPECT_EQ(sid::cached_allocator_statistics().hits, after.hits + 1);
+            }
+            sid::set_cached_allocator_limit(size_t(1) << 30);
+        }
+    } // namespace
+} // namespace gridtools
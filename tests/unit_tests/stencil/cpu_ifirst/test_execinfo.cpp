@@ -0,0 +1,68 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/stencil/cpu_ifirst/execinfo.hpp>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/common/hugepage_alloc.hpp>
+
+using namespace gridtools;
+using namespace stencil;
+using namespace cpu_ifirst_backend;
+
+namespace {
+    struct grid {
+        int_t m_i_size, m_j_size;
+        int_t i_size() const { return m_i_size; }
+        int_t j_size() const { return m_j_size; }
+    };
+
+    struct four_threads {
+        friend int thread_pool_get_max_threads(four_threads) { return 4; }
+    };
+
+    void check_coverage(execinfo const &testee, grid const &g) {
+        int_t i_total = 0;
+        for (int_t i = 0; i < testee.i_blocks(); ++i)
+            i_total += testee.block(i, 0).i_block_size;
+        EXPECT_EQ(i_total, g.i_size());
+        int_t j_total = 0;
+        for (int_t j = 0; j < testee.j_blocks(); ++j)
+            j_total += testee.block(0, j).j_block_size;
+        EXPECT_EQ(j_total, g.j_size());
+    }
+
+    TEST(execinfo, over_decomposition) {
+        grid g = {128, 128};
+        execinfo testee(four_threads(), g);
+        EXPECT_GE(testee.i_blocks() * testee.j_blocks(), 16);
+        // whole rows along i are kept as long as possible
+        EXPECT_EQ(testee.i_blocks(), 1);
+        check_coverage(testee, g);
+    }
+
+    TEST(execinfo, small_domain) {
+        grid g = {5, 3};
+        execinfo testee(four_threads(), g);
+        EXPECT_EQ(testee.i_block_size(), 5);
+        EXPECT_EQ(testee.j_block_size(), 1);
+        check_coverage(testee, g);
+    }
+
+    TEST(execinfo, cache_resident_temporaries) {
+        grid g = {1000, 1000};
+        std::size_t column_bytes = 80 * sizeof(double);
+        execinfo testee(four_threads(), g, column_bytes);
+        std::size_t block_bytes = testee.i_block_size() * testee.j_block_size() * column_bytes;
+        EXPECT_LE(block_bytes, l2_cache_size() / 2);
+        check_coverage(testee, g);
+    }
+} // namespace
@@ -0,0 +1,146 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/stencil/cpu_kfirst_autotuned.hpp>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_kfirst.hpp>
+
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+    using namespace cpu_kfirst_backend;
+
+    using candidates_t = std::vector<std::pair<int_t, int_t>>;
+
+    candidates_t const candidates = {{8, 8}, {4, 4}, {16, 16}};
+    tuning_key const key = {42, 10, 20, 30};
+
+    TEST(tuning_cache, picks_fastest) {
+        tuning_cache testee;
+        double const times[] = {3, 1, 2};
+        for (std::size_t i = 0; i != 2 * candidates.size(); ++i) {
+            auto index = testee.select(key, candidates);
+            EXPECT_EQ(index, i % candidates.size());
+            testee.record(key, candidates, index, times[index], 2);
+        }
+        std::pair<int_t, int_t> winner;
+        ASSERT_TRUE(testee.winner(key, winner));
+        EXPECT_EQ(winner, candidates[1]);
+        EXPECT_EQ(testee.select(key, candidates), 1);
+
+        // other domain sizes are tuned separately
+        EXPECT_FALSE(testee.winner({42, 10, 20, 31}, winner));
+    }
+
+    TEST(tuning_cache, persistence) {
+        std::string file_name = testing::TempDir() + "gt_autotune_cache_test";
+        std::remove(file_name.c_str());
+        {
+            tuning_cache testee(file_name);
+            for (std::size_t i = 0; i != candidates.size(); ++i)
+                testee.record(key, candidates, i, i == 2 ? 1 : 5, 1);
+        }
+        tuning_cache testee(file_name);
+        std::pair<int_t, int_t> winner;
+        ASSERT_TRUE(testee.winner(key, winner));
+        EXPECT_EQ(winner, candidates[2]);
+        EXPECT_EQ(testee.select(key, candidates), 2);
+
+        // the stored winner is not a candidate anymore, the stencil is retuned
+        EXPECT_EQ(testee.select(key, {{2, 2}, {4, 4}}), 0);
+        EXPECT_FALSE(testee.winner(key, winner));
+        std::remove(file_name.c_str());
+    }
+
+    TEST(tuning_cache, shared_file) {
+        std::string file_name = testing::TempDir() + "gt_autotune_cache_shared_test";
+        std::remove(file_name.c_str());
+        tuning_key const other = {43, 10, 20, 30};
+        // two processes sharing the file, each one tunes its own stencil
+        tuning_cache first(file_name);
+        tuning_cache second(file_name);
+        for (std::size_t i = 0; i != candidates.size(); ++i) {
+            first.record(key, candidates, i, i == 2 ? 1 : 5, 1);
+            second.record(other, candidates, i, i == 0 ? 1 : 5, 1);
+        }
+        tuning_cache testee(file_name);
+        std::pair<int_t, int_t> winner;
+        ASSERT_TRUE(testee.winner(key, winner));
+        EXPECT_EQ(winner, candidates[2]);
+        ASSERT_TRUE(testee.winner(other, winner));
+        EXPECT_EQ(winner, candidates[0]);
+        std::remove(file_name.c_str());
+    }
+
+    TEST(tuning_cache, unwritable_file) {
+        tuning_cache testee(testing::TempDir() + "no_such_directory/gt_autotune_cache_test");
+        for (std::size_t i = 0; i != candidates.size(); ++i)
+            testee.record(key, candidates, i, i == 1 ? 1 : 5, 1);
+        std::pair<int_t, int_t> winner;
+        ASSERT_TRUE(testee.winner(key, winner));
+        EXPECT_EQ(winner, candidates[1]);
+    }
+
+    TEST(published_winners, all_keys) {
+        published_winners testee;
+        std::size_t index = 42;
+        EXPECT_FALSE(testee.find(key, index));
+        testee.publish(key, 2);
+        ASSERT_TRUE(testee.find(key, index));
+        EXPECT_EQ(index, 2);
+
+        tuning_key other = {42, 10, 20, 31};
+        EXPECT_FALSE(testee.find(other, index));
+        testee.publish(other, 1);
+        ASSERT_TRUE(testee.find(other, index));
+        EXPECT_EQ(index, 1);
+        ASSERT_TRUE(testee.find(key, index));
+        EXPECT_EQ(index, 2);
+    }
+
+    struct copy_functor {
+        using in = in_accessor<0>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval) {
+            eval(out()) = eval(in());
+        }
+    };
+
+    TEST(cpu_kfirst_autotuned, copy) {
+        using backend_t = cpu_kfirst_autotuned<meta::list<block_sizes<4, 4>, block_sizes<8, 2>>,
+            thread_pool::omp,
+            integral_constant<int, 1>>;
+        auto builder = storage::builder<storage::cpu_kfirst>.type<double>().dimensions(13, 9, 7);
+        auto in = builder.initializer([](int i, int j, int k) { return i + 10 * j + 100 * k; }).build();
+        auto spec = [](auto in, auto out) { return execute_parallel().stage(copy_functor(), in, out); };
+        // two tuning runs, then the winner
+        for (int n = 0; n != 3; ++n) {
+            auto out = builder.value(-1).build();
+            run(spec, backend_t(), make_grid(13, 9, 7), in, out);
+            auto view = out->const_host_view();
+            for (int i = 0; i != 13; ++i)
+                for (int j = 0; j != 9; ++j)
+                    for (int k = 0; k != 7; ++k)
+                        EXPECT_EQ(view(i, j, k), i + 10 * j + 100 * k);
+        }
+    }
+} // namespace
@@ -0,0 +1,143 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/stencil/cpu_kfirst.hpp>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_kfirst.hpp>
+
+namespace {
+    using namespace gridtools;
+    using namespace stencil;
+    using namespace cartesian;
+
+    using axis_t = axis<1, axis_config::offset_limit<3>>;
+    using kfull = axis_t::full_interval;
+
+    constexpr int_t i_size = 11;
+    constexpr int_t j_size = 5;
+    constexpr int_t k_size = 9;
+
+    auto const builder = storage::builder<storage::cpu_kfirst>.type<double>().dimensions(i_size, j_size, k_size);
+
+    double in(int i, int j, int k) { return i + 10 * j + 100 * k; }
+
+    // the cached field is updated in the rolling buffer only, the field in memory keeps its values
+    struct double_and_sum {
+        using a = inout_accessor<0, extent<0, 0, 0, 0, -1, 0>>;
+        using out = inout_accessor<1>;
+        using param_list = make_param_list<a, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::first_level) {
+            eval(a()) = 2 * eval(a());
+            eval(out()) = eval(a());
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::modify<1, 0>) {
+            eval(a()) = 2 * eval(a());
+            eval(out()) = eval(a()) + eval(a(0, 0, -1));
+        }
+    };
+
+    TEST(k_cache, fill_is_not_written_back) {
+        auto a = builder.initializer(in).build();
+        auto out = builder.value(-1).build();
+        auto spec = [](auto a, auto out) {
+            return execute_forward().k_cached(cache_io_policy::fill(), a).stage(double_and_sum(), a, out);
+        };
+        run(spec, cpu_kfirst<>(), make_grid(i_size, j_size, axis_t(k_size)), a, out);
+        auto a_view = a->const_host_view();
+        auto out_view = out->const_host_view();
+        for (int i = 0; i < i_size; ++i)
+            for (int j = 0; j < j_size; ++j) {
+                EXPECT_EQ(out_view(i, j, 0), 2 * in(i, j, 0));
+                for (int k = 1; k < k_size; ++k)
+                    EXPECT_EQ(out_view(i, j, k), 2 * in(i, j, k) + 2 * in(i, j, k - 1));
+                for (int k = 0; k < k_size; ++k)
+                    EXPECT_EQ(a_view(i, j, k), in(i, j, k));
+            }
+    }
+
+    // partial sums along the column, the levels outside of the computation area are not flushed
+    struct partial_sum {
+        using in = in_accessor<0>;
+        using out = inout_accessor<1, extent<0, 0, 0, 0, -1, 1>>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::modify<1, -1>::first_level) {
+            eval(out()) = eval(in());
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::modify<2, -1>) {
+            eval(out()) = eval(in()) + eval(out(0, 0, -1));
+        }
+    };
+
+    struct partial_sum_backward {
+        using in = in_accessor<0>;
+        using out = inout_accessor<1, extent<0, 0, 0, 0, -1, 1>>;
+        using param_list = make_param_list<in, out>;
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::modify<1, -1>::last_level) {
+            eval(out()) = eval(in());
+        }
+
+        template <class Eval>
+        GT_FUNCTION static void apply(Eval &&eval, kfull::modify<1, -2>) {
+            eval(out()) = eval(in()) + eval(out(0, 0, 1));
+        }
+    };
+
+    TEST(k_cache, flush_forward) {
+        auto out = builder.value(-1).build();
+        auto spec = [](auto in, auto out) {
+            return execute_forward().k_cached(cache_io_policy::flush(), out).stage(partial_sum(), in, out);
+        };
+        run(spec, cpu_kfirst<>(), make_grid(i_size, j_size, axis_t(k_size)), builder.initializer(in).build(), out);
+        auto view = out->const_host_view();
+        for (int i = 0; i < i_size; ++i)
+            for (int j = 0; j < j_size; ++j) {
+                EXPECT_EQ(view(i, j, 0), -1);
+                double sum = 0;
+                for (int k = 1; k < k_size - 1; ++k) {
+                    sum += in(i, j, k);
+                    EXPECT_EQ(view(i, j, k), sum);
+                }
+                EXPECT_EQ(view(i, j, k_size - 1), -1);
+            }
+    }
+
+    TEST(k_cache, flush_backward) {
+        auto out = builder.value(-1).build();
+        auto spec = [](auto in, auto out) {
+            return execute_backward().k_cached(cache_io_policy::flush(), out).stage(partial_sum_backward(), in, out);
+        };
+        run(spec, cpu_kfirst<>(), make_grid(i_size, j_size, axis_t(k_size)), builder.initializer(in).build(), out);
+        auto view = out->const_host_view();
+        for (int i = 0; i < i_size; ++i)
+            for (int j = 0; j < j_size; ++j) {
+                EXPECT_EQ(view(i, j, k_size - 1), -1);
+                double sum = 0;
+                for (int k = k_size - 2; k > 0; --k) {
+                    sum += in(i, j, k);
+                    EXPECT_EQ(view(i, j, k), sum);
+                }
+                EXPECT_EQ(view(i, j, 0), -1);
+            }
+    }
+} // namespace
@@ -0,0 +1,129 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/stencil/common/instrumentation.hpp>
+
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/cpu_ifirst.hpp>
+#include <gridtools/stencil/cpu_kfirst.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+#include <gridtools/storage/cpu_kfirst.hpp>
+
+namespace gridtools {
+    namespace stencil {
+        namespace {
+            using namespace cartesian;
+
+            struct scale_functor {
+                using in = in_accessor<0>;
+                using out = inout_accessor<1>;
+                using param_list = make_param_list<in, out>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    eval(out()) = 2 * eval(in());
+                }
+            };
+
+            struct shift_functor {
+                using in = in_accessor<0, extent<-1, 1>>;
+                using out = inout_accessor<1>;
+                using param_list = make_param_list<in, out>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    eval(out()) = eval(in(1, 0, 0)) + eval(in(-1, 0, 0));
+                }
+            };
+
+            struct sum_functor {
+                using in = in_accessor<0, extent<0, 0, 0, 0, -1, 0>>;
+                using out = inout_accessor<1>;
+                using param_list = make_param_list<in, out>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval, axis<1>::full_interval::modify<1, 0>) {
+                    eval(out()) = eval(in()) + eval(in(0, 0, -1));
+                }
+            };
+
+            template <class Backend, class StorageTraits>
+            std::string profile() {
+                instrumentation::reset();
+                instrumentation::enable();
+                auto builder = storage::builder<StorageTraits>.template type<double>().dimensions(20, 15, 7);
+                auto in = builder.value(1).build();
+                auto out = builder.value(0).build();
+                run(
+                    [](auto in, auto out) {
+                        GT_DECLARE_TMP(double, tmp);
+                        return execute_parallel().stage(scale_functor(), in, tmp).stage(shift_functor(), tmp, out);
+                    },
+                    Backend(),
+                    make_grid({1, 1, 1, 18, 20}, 15, 7),
+                    in,
+                    out);
+                instrumentation::disable();
+                EXPECT_EQ(out->const_host_view()(5, 5, 5), 4);
+                std::ostringstream res;
+                instrumentation::write_json(res);
+                return res.str();
+            }
+
+            TEST(instrumentation, cpu_kfirst) {
+                auto res = profile<cpu_kfirst<>, storage::cpu_kfirst>();
+                EXPECT_NE(res.find("scale_functor"), std::string::npos) << res;
+                EXPECT_NE(res.find("shift_functor"), std::string::npos) << res;
+                EXPECT_NE(res.find("\"seconds\""), std::string::npos) << res;
+            }
+
+            TEST(instrumentation, cpu_kfirst_k_cached) {
+                instrumentation::reset();
+                instrumentation::enable();
+                auto builder = storage::builder<storage::cpu_kfirst>.type<double>().dimensions(20, 15, 7);
+                auto in = builder.value(1).build();
+                auto out = builder.value(0).build();
+                run(
+                    [](auto in, auto out) {
+                        return execute_forward().k_cached(cache_io_policy::fill(), in).stage(sum_functor(), in, out);
+                    },
+                    cpu_kfirst<>(),
+                    make_grid(20, 15, axis<1>(7)),
+                    in,
+                    out);
+                instrumentation::disable();
+                EXPECT_EQ(out->const_host_view()(5, 5, 5), 2);
+                std::ostringstream res;
+                instrumentation::write_json(res);
+                EXPECT_NE(res.str().find("sum_functor"), std::string::npos) << res.str();
+            }
+
+            TEST(instrumentation, cpu_ifirst) {
+                auto res = profile<cpu_ifirst<>, storage::cpu_ifirst>();
+                EXPECT_NE(res.find("scale_functor"), std::string::npos) << res;
+                EXPECT_NE(res.find("shift_functor"), std::string::npos) << res;
+            }
+
+            TEST(instrumentation, disabled) {
+                instrumentation::reset();
+                instrumentation::disable();
+                std::ostringstream res;
+                instrumentation::write_json(res);
+                EXPECT_EQ(res.str().find("\"calls\": 1"), std::string::npos) << res.str();
+            }
+        } // namespace
+    }     // namespace stencil
+} // namespace gridtools
@@ -0,0 +1,184 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/stencil/traffic.hpp>
+
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/cpu_kfirst.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_kfirst.hpp>
+
+namespace gridtools {
+    namespace stencil {
+        namespace {
+            using namespace cartesian;
+
+            struct copy_functor {
+                using in = in_accessor<0>;
+                using out = inout_accessor<1>;
+                using param_list = make_param_list<in, out>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    eval(out()) = eval(in());
+                }
+            };
+
+            struct lap_functor {
+                using in = in_accessor<0, extent<-1, 1, -1, 1>>;
+                using out = inout_accessor<1>;
+                using param_list = make_param_list<in, out>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    eval(out()) = 4 * eval(in()) - eval(in(1, 0)) - eval(in(-1, 0)) - eval(in(0, 1)) - eval(in(0, -1));
+                }
+            };
+
+            struct scale_functor {
+                using in = in_accessor<0, extent<-1, 1>>;
+                using coeff = in_accessor<1>;
+                using out = inout_accessor<2>;
+                using param_list = make_param_list<in, coeff, out>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval) {
+                    eval(out()) = eval(coeff()) * (eval(in(1, 0)) - eval(in(-1, 0)));
+                }
+            };
+
+            template <class Backend, class Stencil, class... Args>
+            std::string report(Stencil stencil, Args &&...args) {
+                std::ostringstream res;
+                halo_descriptor i_halo(2, 2, 2, 11, 14);
+                halo_descriptor j_halo(1, 1, 1, 12, 14);
+                run(stencil, traffic<Backend>{res, 10}, make_grid(i_halo, j_halo, 5), std::forward<Args>(args)...);
+                return res.str();
+            }
+
+            TEST(traffic, copy) {
+                float in[14][14][5];
+                double out[14][14][5];
+                auto res = report<void>(
+                    [](auto in, auto out) { return execute_parallel().stage(copy_functor(), in, out); }, in, out);
+                EXPECT_NE(res.find("copy_functor"), std::string::npos) << res;
+                EXPECT_NE(res.find("\"domain\": [10, 12, 5]"), std::string::npos) << res;
+                EXPECT_NE(res.find("\"compulsory_bytes_per_point\": {\"read\": 12, \"written\": 8, \"tmp\": 0"),
+                    std::string::npos)
+                    << res;
+                EXPECT_EQ(res.find("seconds"), std::string::npos) << res;
+            }
+
+            // the laplacian is computed on the domain extended in i, that is on 12 x 12 points, every point reads `in`
+            // and writes the temporary
+            TEST(traffic, temporaries) {
+                double in[14][14][5];
+                double coeff[14][14][5];
+                double out[14][14][5];
+                auto stencil = [](auto in, auto coeff, auto out) {
+                    GT_DECLARE_TMP(double, lap);
+                    return execute_parallel().stage(lap_functor(), in, lap).stage(scale_functor(), lap, coeff, out);
+                };
+                auto res = report<void>(stencil, in, coeff, out);
+                EXPECT_NE(res.find("\"stage\": \"gridtools::stencil::(anonymous namespace)::lap_functor\", "
+                                   "\"bytes_per_point\": {\"read\": 9.6, \"written\": 0, \"tmp\": 9.6"),
+                    std::string::npos)
+                    << res;
+                EXPECT_NE(res.find("\"compulsory_bytes_per_point\": {\"read\": 24, \"written\": 8, \"tmp\": 0"),
+                    std::string::npos)
+                    << res;
+            }
+
+            TEST(traffic, ij_cached_temporaries) {
+                double in[14][14][5];
+                double coeff[14][14][5];
+                double out[14][14][5];
+                auto stencil = [](auto in, auto coeff, auto out) {
+                    GT_DECLARE_TMP(double, lap);
+                    return execute_parallel()
+                        .ij_cached(lap)
+                        .stage(lap_functor(), in, lap)
+                        .stage(scale_functor(), lap, coeff, out);
+                };
+                auto res = report<void>(stencil, in, coeff, out);
+                EXPECT_NE(res.find("\"streamed_bytes_per_point\": {\"read\": 25.6, \"written\": 8, \"tmp\": 0"),
+                    std::string::npos)
+                    << res;
+            }
+
+            using axis_t = axis<1, axis_config::offset_limit<3>>;
+            using kfull = axis_t::full_interval;
+
+            struct sum_functor {
+                using in = in_accessor<0>;
+                using out = inout_accessor<1, extent<0, 0, 0, 0, -1, 0>>;
+                using param_list = make_param_list<in, out>;
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval, kfull::first_level) {
+                    eval(out()) = eval(in());
+                }
+
+                template <class Eval>
+                GT_FUNCTION static void apply(Eval &&eval, kfull::modify<1, 0>) {
+                    eval(out()) = eval(in()) + eval(out(0, 0, -1));
+                }
+            };
+
+            // the flushed k-cache is only written by the single stage that accesses it
+            TEST(traffic, local_k_cache) {
+                double in[10][12][5];
+                double out[10][12][5];
+                std::ostringstream res;
+                auto stencil = [](auto in, auto out) {
+                    return execute_forward().k_cached(cache_io_policy::flush(), out).stage(sum_functor(), in, out);
+                };
+                run(stencil, traffic<void>{res}, make_grid(10, 12, axis_t(5)), in, out);
+                EXPECT_NE(res.str().find("\"streamed_bytes_per_point\": {\"read\": 8, \"written\": 8, \"tmp\": 0"),
+                    std::string::npos)
+                    << res.str();
+            }
+
+            // a k-cache shared with another multistage is accessed in memory
+            TEST(traffic, shared_k_cache) {
+                double in[10][12][5];
+                double out[10][12][5];
+                double copy[10][12][5];
+                std::ostringstream res;
+                auto stencil = [](auto in, auto out, auto copy) {
+                    return multi_pass(
+                        execute_forward().k_cached(cache_io_policy::flush(), out).stage(sum_functor(), in, out),
+                        execute_parallel().stage(copy_functor(), out, copy));
+                };
+                run(stencil, traffic<void>{res}, make_grid(10, 12, axis_t(5)), in, out, copy);
+                EXPECT_NE(res.str().find("\"streamed_bytes_per_point\": {\"read\": 24, \"written\": 16, \"tmp\": 0"),
+                    std::string::npos)
+                    << res.str();
+            }
+
+            TEST(traffic, measured) {
+                auto builder = storage::builder<storage::cpu_kfirst>.type<double>().dimensions(14, 14, 5);
+                auto in = builder.value(1).build();
+                auto out = builder.value(0).build();
+                auto res = report<cpu_kfirst<>>(
+                    [](auto in, auto out) { return execute_parallel().stage(copy_functor(), in, out); }, in, out);
+                EXPECT_EQ(out->const_host_view()(3, 4, 2), 1);
+                EXPECT_NE(res.find("\"seconds\""), std::string::npos) << res;
+                EXPECT_NE(res.find("\"compulsory_stream_fraction\""), std::string::npos) << res;
+                EXPECT_NE(res.find("\"stream_gbps\": 10"), std::string::npos) << res;
+            }
+        } // namespace
+    }     // namespace stencil
+} // namespace gridtools
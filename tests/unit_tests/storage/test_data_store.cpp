@@ -11,6 +11,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <gridtools/common/omp.hpp>
 #include <gridtools/storage/builder.hpp>
 
 #include <storage_select.hpp>
@@ -58,6 +59,67 @@ TEST(DataStoreTest, LambdaInitializer) {
                 EXPECT_DOUBLE_EQ(view(i, j, k), i + j + k);
 }
 
+TEST(DataStoreTest, LambdaInitializerSeveralPages) {
+    // the elements are initialized page by page, by the threads that own the pages
+    auto ds = builder.dimensions(67, 45, 33)
+                  .halos(3, 2, 0)
+                  .initializer([](int i, int j, int k) { return i + 100 * j + 10000 * k; })
+                  .build();
+    auto view = ds->const_host_view();
+    for (int i = 0; i < 67; ++i)
+        for (int j = 0; j < 45; ++j)
+            for (int k = 0; k < 33; ++k)
+                EXPECT_EQ(view(i, j, k), i + 100 * j + 10000 * k);
+}
+
+TEST(DataStoreTest, ValueInitializerFourDimensions) {
+    auto ds = builder.dimensions(23, 17, 11, 3).value(2.5).build();
+    auto view = ds->const_host_view();
+    for (int i = 0; i < 23; ++i)
+        for (int j = 0; j < 17; ++j)
+            for (int k = 0; k < 11; ++k)
+                for (int l = 0; l < 3; ++l)
+                    EXPECT_EQ(view(i, j, k, l), 2.5);
+}
+
+TEST(DataStoreTest, LambdaInitializerMoreThreadsThanRows) {
+    // most threads own no slab of the partitioned dimension, the last one owns the padding
+    int threads = omp_get_max_threads();
+    omp_set_num_threads(7);
+    auto ds = builder.dimensions(3, 2, 700)
+                  .initializer([](int i, int j, int k) { return i + 10 * j + 100 * k; })
+                  .build();
+    omp_set_num_threads(threads);
+    auto view = ds->const_host_view();
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 2; ++j)
+            for (int k = 0; k < 700; ++k)
+                EXPECT_EQ(view(i, j, k), i + 10 * j + 100 * k);
+}
+
+TEST(DataStoreTest, LambdaInitializerCustomLayout) {
+    auto ds = builder.dimensions(10, 11, 12)
+                  .layout<1, 2, 0>()
+                  .initializer([](int i, int j, int k) { return i + 100 * j + 10000 * k; })
+                  .build();
+    auto view = ds->const_host_view();
+    for (int i = 0; i < 10; ++i)
+        for (int j = 0; j < 11; ++j)
+            for (int k = 0; k < 12; ++k)
+                EXPECT_EQ(view(i, j, k), i + 100 * j + 10000 * k);
+}
+
+TEST(DataStoreTest, LambdaInitializerMasked) {
+    auto ds = builder.dimensions(10, 11, 12)
+                  .selector<1, 0, 1>()
+                  .initializer([](int i, int, int k) { return i + 10000 * k; })
+                  .build();
+    auto view = ds->const_host_view();
+    for (int i = 0; i < 10; ++i)
+        for (int k = 0; k < 12; ++k)
+            EXPECT_EQ(view(i, 0, k), i + 10000 * k);
+}
+
 TEST(DataStoreTest, Naming) {
     auto builder = ::builder.dimensions(10, 11, 12);
     // no naming
@@ -0,0 +1,87 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#include <gridtools/storage/soa.hpp>
+
+#include <atomic>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/common/integral_constant.hpp>
+#include <gridtools/common/tuple.hpp>
+#include <gridtools/common/tuple_util.hpp>
+#include <gridtools/sid/concept.hpp>
+#include <gridtools/storage/builder.hpp>
+
+#include <storage_select.hpp>
+
+namespace gridtools {
+    namespace {
+        using namespace literals;
+        using tuple_util::get;
+
+        const auto builder = storage::builder<storage_traits_t>.type<tuple<double, double>>().soa();
+
+        TEST(soa, sid) {
+            auto testee = builder.dimensions(4, 5).initializer([](int i, int j) { return tuple(i + .5, 10. * j); })();
+            using testee_t = decltype(testee);
+
+            static_assert(storage::is_soa_data_store<typename testee_t::element_type>::value);
+            static_assert(sid::concept_impl_::is_sid<testee_t>());
+            static_assert(tuple_util::size<sid::strides_type<testee_t>>::value == 2);
+
+            EXPECT_EQ(testee->lengths(), (array<uint_t, 2>{4, 5}));
+            EXPECT_EQ(testee->planes()->lengths(), (array<uint_t, 3>{4, 5, 2}));
+
+            auto ptr = sid::get_origin(testee)();
+            auto strides = sid::get_strides(testee);
+            sid::shift(ptr, sid::get_stride<integral_constant<int, 0>>(strides), 3);
+            sid::shift(ptr, sid::get_stride<integral_constant<int, 1>>(strides), 2);
+            auto val = *ptr;
+            EXPECT_EQ(get<0>(val), 3.5);
+            EXPECT_EQ(get<1>(val), 20.);
+
+            *ptr = tuple(1., 2.);
+            auto view = testee->planes()->const_host_view();
+            EXPECT_EQ(view(3, 2, 0), 1.);
+            EXPECT_EQ(view(3, 2, 1), 2.);
+            EXPECT_EQ(view(3, 1, 0), 3.5);
+        }
+
+        TEST(soa, planes_are_contiguous) {
+            auto testee = builder.dimensions(4, 5).value(tuple(1., 2.))();
+            auto view = testee->planes()->const_host_view();
+            auto &&strides = testee->planes()->strides();
+            EXPECT_GE(strides[2], 4 * 5);
+            for (int i = 0; i < 4; ++i)
+                for (int j = 0; j < 5; ++j) {
+                    EXPECT_EQ(view(i, j, 0), 1.);
+                    EXPECT_EQ(view(i, j, 1), 2.);
+                }
+        }
+
+        TEST(soa, initializer_is_called_once_per_point) {
+            std::atomic<int> calls(0);
+            auto testee = builder.dimensions(4, 5)
+                              .initializer([&](int i, int j) {
+                                  ++calls;
+                                  return tuple(i + .5, 10. * j);
+                              })
+                              .build();
+            EXPECT_EQ(calls, 4 * 5);
+            auto view = testee->planes()->const_host_view();
+            for (int i = 0; i < 4; ++i)
+                for (int j = 0; j < 5; ++j) {
+                    EXPECT_EQ(view(i, j, 0), i + .5);
+                    EXPECT_EQ(view(i, j, 1), 10. * j);
+                }
+        }
+    } // namespace
+} // namespace gridtools
@@ -0,0 +1,138 @@
+/*
+ * GridTools
+ *
+ * Copyright (c) 2014-2021, ETH Zurich
+ * All rights reserved.
+ *
+ * Please, refer to the LICENSE file in the root directory.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <gridtools/thread_pool/work_stealing.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gridtools/stencil/cartesian.hpp>
+#include <gridtools/stencil/cpu_ifirst.hpp>
+#include <gridtools/stencil/cpu_kfirst.hpp>
+#include <gridtools/storage/builder.hpp>
+#include <gridtools/storage/cpu_ifirst.hpp>
+#include <gridtools/storage/cpu_kfirst.hpp>
+#include <gridtools/thread_pool/concept.hpp>
+
+namespace gridtools {
+    namespace {
+        using thread_pool::work_stealing;
+
+        TEST(work_stealing, max_threads) { EXPECT_GE(thread_pool::get_max_threads(work_stealing()), 1); }
+
+        TEST(work_stealing, loop_1d) {
+            std::vector<std::atomic<int>> visits(1001);
+            std::atomic<bool> valid_thread_nums(true);
+            thread_pool::parallel_for_loop(
+                work_stealing(),
+                [&](int i) {
+                    int thread_num = thread_pool::get_thread_num(work_stealing());
+                    if (thread_num < 0 || thread_num >= thread_pool::get_max_threads(work_stealing()))
+                        valid_thread_nums = false;
+                    ++visits[i];
+                },
+                1001);
+            for (auto const &v : visits)
+                EXPECT_EQ(v, 1);
+            EXPECT_TRUE(valid_thread_nums);
+        }
+
+        TEST(work_stealing, loop_2d) {
+            std::vector<std::atomic<int>> visits(7 * 5);
+            thread_pool::parallel_for_loop(work_stealing(), [&](int i, int j) { ++visits[i + 7 * j]; }, 7, 5);
+            for (auto const &v : visits)
+                EXPECT_EQ(v, 1);
+        }
+
+        TEST(work_stealing, loop_3d) {
+            std::vector<std::atomic<int>> visits(7 * 5 * 3);
+            thread_pool::parallel_for_loop(
+                work_stealing(), [&](int i, int j, int k) { ++visits[i + 7 * j + 35 * k]; }, 7, 5, 3);
+            for (auto const &v : visits)
+                EXPECT_EQ(v, 1);
+        }
+
+        TEST(work_stealing, empty_loop) {
+            thread_pool::parallel_for_loop(
+                work_stealing(), [&](int, int) { ADD_FAILURE(); }, 0, 5);
+        }
+
+        TEST(work_stealing, concurrent_callers) {
+            std::vector<std::atomic<int>> visits(2 * 1001);
+            auto caller = [&](int offset) {
+                for (int n = 0; n != 1000; ++n)
+                    thread_pool::parallel_for_loop(work_stealing(), [&](int i) { ++visits[offset + i]; }, 1001);
+            };
+            std::thread other(caller, 1001);
+            caller(0);
+            other.join();
+            for (auto const &v : visits)
+                EXPECT_EQ(v, 1000);
+        }
+
+        TEST(work_stealing, nested_loop) {
+            std::vector<std::atomic<int>> visits(20 * 30);
+            thread_pool::parallel_for_loop(
+                work_stealing(),
+                [&](int i) {
+                    thread_pool::parallel_for_loop(work_stealing(), [&](int j) { ++visits[i + 20 * j]; }, 30);
+                },
+                20);
+            for (auto const &v : visits)
+                EXPECT_EQ(v, 1);
+        }
+
+        using namespace stencil;
+        using namespace cartesian;
+
+        struct copy_functor {
+            using in = in_accessor<0>;
+            using out = inout_accessor<1>;
+            using param_list = make_param_list<in, out>;
+
+            template <class Eval>
+            GT_FUNCTION static void apply(Eval &&eval) {
+                eval(out()) = eval(in());
+            }
+        };
+
+        // copy through a temporary that is allocated per thread
+        template <class Backend, class StorageTraits>
+        void test_copy() {
+            auto builder = storage::builder<StorageTraits>.template type<double>().dimensions(37, 23, 11);
+            auto in = builder.initializer([](int i, int j, int k) { return i + 100 * j + 10000 * k; }).build();
+            auto out = builder.value(-1).build();
+            run(
+                [](auto in, auto out) {
+                    GT_DECLARE_TMP(double, tmp);
+                    return execute_parallel().stage(copy_functor(), in, tmp).stage(copy_functor(), tmp, out);
+                },
+                Backend(),
+                make_grid(37, 23, 11),
+                in,
+                out);
+            auto view = out->const_host_view();
+            for (int i = 0; i != 37; ++i)
+                for (int j = 0; j != 23; ++j)
+                    for (int k = 0; k != 11; ++k)
+                        EXPECT_EQ(view(i, j, k), i + 100 * j + 10000 * k);
+        }
+
+        TEST(work_stealing, cpu_kfirst) {
+            test_copy<cpu_kfirst<integral_constant<int_t, 8>, integral_constant<int_t, 8>, work_stealing>,
+                storage::cpu_kfirst>();
+        }
+
+        TEST(work_stealing, cpu_ifirst) { test_copy<cpu_ifirst<work_stealing>, storage::cpu_ifirst>(); }
+    } // namespace
+} // namespace gridtools